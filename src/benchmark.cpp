@@ -17,13 +17,33 @@
 */
 
 #include "benchmark.h"
+#include "movegen.h"
+#include "nnue/network.h"
+#include "nnue/nnue_accumulator.h"
 #include "numa.h"
+#include "position.h"
+#include "search.h"
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
 #include <cstdlib>
+#include <cstring>
+#include <deque>
 #include <fstream>
+#include <iomanip>
 #include <iostream>
+#include <limits>
+#include <sstream>
+#include <thread>
 #include <vector>
 
+#if defined(_MSC_VER)
+    #include <intrin.h>
+#elif defined(__x86_64__) || defined(__i386__)
+    #include <x86intrin.h>
+#endif
+
 namespace {
 
 // clang-format off
@@ -372,6 +392,255 @@ const std::vector<std::vector<std::string>> BenchmarkPositions = {
 };
 // clang-format on
 
+// Makes and unmakes all the moves of the tree of the given depth, and returns
+// their number
+template<bool Light>
+uint64_t make_unmake(Stockfish::Position& pos, Stockfish::Depth depth) {
+
+    Stockfish::StateInfo st;
+    uint64_t             moves = 0;
+
+    for (const auto& m : Stockfish::MoveList<Stockfish::LEGAL>(pos))
+    {
+        if constexpr (Light)
+            pos.do_light_move(m, st);
+        else
+            pos.do_move(m, st);
+
+        moves += 1 + (depth > 1 ? make_unmake<Light>(pos, depth - 1) : 0);
+        pos.undo_move(m);
+    }
+
+    return moves;
+}
+
+// Walks the tree of the given depth as the search does, updating the accumulators
+// of the big net at each move when Update, and returns the number of moves
+template<bool Update>
+uint64_t walk_accumulators(Stockfish::Position&                      pos,
+                           Stockfish::Depth                          depth,
+                           const Stockfish::Eval::NNUE::Networks&    networks,
+                           Stockfish::Eval::NNUE::AccumulatorStack&  stack,
+                           Stockfish::Eval::NNUE::AccumulatorCaches& caches,
+                           bool                                      fuse) {
+    using namespace Stockfish;
+
+    StateInfo st;
+    uint64_t  moves = 0;
+
+    for (const auto& m : MoveList<LEGAL>(pos))
+    {
+        auto [dirtyPiece, dirtyThreats] = stack.push();
+        pos.do_move(m, st, pos.gives_check(m), dirtyPiece, dirtyThreats, nullptr);
+
+        if constexpr (Update)
+            networks.big.update_accumulators(pos, stack, caches.big, fuse);
+
+        moves += 1;
+
+        if (depth > 1)
+            moves += walk_accumulators<Update>(pos, depth - 1, networks, stack, caches, fuse);
+
+        pos.undo_move(m);
+        stack.pop();
+    }
+
+    return moves;
+}
+
+// Ticks of the time stamp counter, which runs at the nominal frequency of the
+// CPU, or 0 where it cannot be read
+uint64_t cycles() {
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    return 0;
+#endif
+}
+
+// The total time of the calls of one stage of the evaluation
+struct StageTime {
+    std::string name;
+    uint64_t    calls = 0, ns = 0, ticks = 0;
+};
+
+// Runs f, which makes the given number of calls of the stage
+template<typename F>
+void time_stage(StageTime& stage, uint64_t calls, const F& f) {
+    const auto     start      = std::chrono::steady_clock::now();
+    const uint64_t startTicks = cycles();
+
+    f();
+
+    stage.ticks += cycles() - startTicks;
+    stage.ns += std::chrono::duration_cast<std::chrono::nanoseconds>(
+                  std::chrono::steady_clock::now() - start)
+                  .count();
+    stage.calls += calls;
+}
+
+// Times the stages of the evaluation of a network over the positions of the
+// game lines: the refresh of the accumulators at the first position of a line
+// from emptied accumulator cache entries, their incremental update after each
+// move, the output of the feature transformer, and then each layer of the layer
+// stack.
+template<typename Net, typename Cache>
+std::vector<StageTime> time_network_stages(const Net&                      net,
+                                           Cache&                          cache,
+                                           const std::vector<std::string>& fens,
+                                           int                             rounds) {
+    using namespace Stockfish;
+    using namespace Stockfish::Eval::NNUE;
+
+    using Arch                    = std::decay_t<decltype(net.layer_stack(0))>;
+    constexpr IndexType L1        = Arch::TransformedFeatureDimensions;
+    constexpr int       LinePlies = 8;
+    constexpr int       Reps      = 16;
+
+    struct alignas(CacheLineSize) Sample {
+        TransformedFeatureType features[L1];
+        int                    bucket;
+    };
+
+    // The outputs of the layers, as the buffer of NetworkArchitecture::propagate()
+    struct alignas(CacheLineSize) Outputs {
+        alignas(CacheLineSize) typename decltype(Arch::fc_0)::OutputBuffer fc_0_out;
+        alignas(CacheLineSize) typename decltype(Arch::ac_sqr_0)::OutputType
+          ac_sqr_0_out[ceil_to_multiple<IndexType>(Arch::FC_0_OUTPUTS * 2, 32)];
+        alignas(CacheLineSize) typename decltype(Arch::ac_0)::OutputBuffer ac_0_out;
+        alignas(CacheLineSize) typename decltype(Arch::fc_1)::OutputBuffer fc_1_out;
+        alignas(CacheLineSize) typename decltype(Arch::ac_1)::OutputBuffer ac_1_out;
+        alignas(CacheLineSize) typename decltype(Arch::fc_2)::OutputBuffer fc_2_out;
+        IndexType                                                          nnzCount;
+    };
+
+    std::vector<StageTime> stages = {{"refresh (caches)"},
+                                     {"incremental update"},
+                                     {"transform"},
+                                     {"fc_0 (sparse input)"},
+                                     {"  find_nnz"},
+                                     {"ac_sqr_0 (SqrClippedReLU)"},
+                                     {"ac_0 (ClippedReLU)"},
+                                     {"fc_1 (AffineTransform)"},
+                                     {"ac_1 (ClippedReLU)"},
+                                     {"fc_2 (AffineTransform)"},
+                                     {"propagate"}};
+
+    auto stack = std::make_unique<AccumulatorStack>();
+
+    // An entry holding only the biases, as after clearing the caches
+    cache.clear(net);
+    const auto emptyEntry = std::make_unique<typename Cache::Entry>(cache[SQ_A1][WHITE]);
+
+    std::vector<Sample> samples;
+
+    for (int round = 0; round < rounds; ++round)
+        for (size_t i = 0; i < fens.size(); ++i)
+        {
+            std::deque<StateInfo> states(1);
+            Position              pos;
+            pos.set(fens[i], false, &states.back());
+
+            // The cache entries of both kings are emptied before each refresh,
+            // otherwise they would already match the position after the first one
+            const Square wksq = pos.square<KING>(WHITE);
+            const Square bksq = pos.square<KING>(BLACK);
+
+            for (int r = 0; r < Reps; ++r)
+            {
+                cache[wksq][WHITE] = *emptyEntry;
+                cache[bksq][BLACK] = *emptyEntry;
+
+                time_stage(stages[0], 1, [&]() {
+                    stack->reset();
+                    net.update_accumulators(pos, *stack, cache, false);
+                });
+            }
+
+            // The moves of a line are picked by their index in the move list, so
+            // that the lines are the same for every build
+            for (int ply = 0; ply <= LinePlies; ++ply)
+            {
+                if (ply > 0)
+                {
+                    const MoveList<LEGAL> moves(pos);
+                    if (!moves.size())
+                        break;
+
+                    const Move m = *(moves.begin() + (ply * 7 + i) % moves.size());
+
+                    auto [dirtyPiece, dirtyThreats] = stack->push();
+                    pos.do_move(m, states.emplace_back(), pos.gives_check(m), dirtyPiece,
+                                dirtyThreats, nullptr);
+
+                    time_stage(stages[1], 1,
+                               [&]() { net.update_accumulators(pos, *stack, cache, false); });
+                }
+
+                Sample sample;
+                sample.bucket = (pos.count<ALL_PIECES>() - 1) / 4;
+
+                time_stage(stages[2], Reps, [&]() {
+                    for (int r = 0; r < Reps; ++r)
+                        net.transform(pos, *stack, cache, sample.features, sample.bucket);
+                });
+
+                if (round == 0)
+                    samples.push_back(sample);
+            }
+        }
+
+    std::vector<Outputs> outputs(samples.size());
+    const uint64_t       calls = uint64_t(samples.size()) * Reps;
+
+    auto time_layer = [&](StageTime& stage, const auto& run) {
+        for (int round = 0; round < rounds; ++round)
+            time_stage(stage, calls, [&]() {
+                for (int r = 0; r < Reps; ++r)
+                    for (size_t s = 0; s < samples.size(); ++s)
+                        run(net.layer_stack(samples[s].bucket), samples[s].features, outputs[s]);
+            });
+    };
+
+    time_layer(stages[3], [](const Arch& arch, const auto* features, Outputs& out) {
+        arch.fc_0.propagate(features, out.fc_0_out);
+    });
+
+#if (USE_SSSE3 | (USE_NEON >= 8))
+    time_layer(stages[4], [](const Arch&, const auto* features, Outputs& out) {
+        constexpr IndexType NumChunks = ceil_to_multiple<IndexType>(L1, 8) / 4;
+
+        std::uint16_t nnz[NumChunks];
+        IndexType     count;
+        Layers::find_nnz<NumChunks>(reinterpret_cast<const std::int32_t*>(features), nnz, count);
+        out.nnzCount += count;
+    });
+#endif
+
+    time_layer(stages[5], [](const Arch& arch, const auto*, Outputs& out) {
+        arch.ac_sqr_0.propagate(out.fc_0_out, out.ac_sqr_0_out);
+    });
+    time_layer(stages[6], [](const Arch& arch, const auto*, Outputs& out) {
+        arch.ac_0.propagate(out.fc_0_out, out.ac_0_out);
+        std::memcpy(out.ac_sqr_0_out + Arch::FC_0_OUTPUTS, out.ac_0_out,
+                    Arch::FC_0_OUTPUTS * sizeof(typename decltype(Arch::ac_0)::OutputType));
+    });
+    time_layer(stages[7], [](const Arch& arch, const auto*, Outputs& out) {
+        arch.fc_1.propagate(out.ac_sqr_0_out, out.fc_1_out);
+    });
+    time_layer(stages[8], [](const Arch& arch, const auto*, Outputs& out) {
+        arch.ac_1.propagate(out.fc_1_out, out.ac_1_out);
+    });
+    time_layer(stages[9], [](const Arch& arch, const auto*, Outputs& out) {
+        arch.fc_2.propagate(out.ac_1_out, out.fc_2_out);
+    });
+    time_layer(stages[10], [](const Arch& arch, const auto* features, Outputs& out) {
+        out.fc_2_out[0] += arch.propagate(features);
+    });
+
+    return stages;
+}
+
 }  // namespace
 
 namespace Stockfish::Benchmark {
@@ -513,4 +782,378 @@ BenchmarkSetup setup_benchmark(std::istream& is) {
     return setup;
 }
 
+// Builds the command list of the A/B comparison of the search backends: the bench
+// of the given positions, searched to a fixed depth once with each backend. The
+// arguments are the TT size in MB, the number of threads, the depth and the
+// positions, as for bench. Examples:
+//
+// bench_ab                     : search the default positions to depth 13
+// bench_ab 64 1 16             : search the default positions to depth 16 (TT = 64MB)
+// bench_ab 16 1 20 current     : search the current position to depth 20
+std::vector<std::string> setup_search_ab(const std::string& currentFen, std::istream& is) {
+
+    std::string token;
+
+    std::string ttSize  = (is >> token) ? token : "16";
+    std::string threads = (is >> token) ? token : "1";
+    std::string depth   = (is >> token) ? token : "13";
+    std::string fenFile = (is >> token) ? token : "default";
+
+    std::istringstream benchArgs(ttSize + " " + threads + " " + depth + " " + fenFile + " depth");
+    const std::vector<std::string> bench = setup_bench(currentFen, benchArgs);
+
+    // Each bench starts with a ucinewgame, so both backends start from an empty
+    // hash and cleared histories
+    std::vector<std::string> list;
+
+    for (const char* backend : {"classic", "v3"})
+    {
+        list.emplace_back(std::string("setoption name SearchBackend value ") + backend);
+        list.insert(list.end(), bench.begin(), bench.end());
+    }
+
+    return list;
+}
+
+void SearchABResult::add_search(uint64_t                      searchNodes,
+                                TimePoint                     searchTime,
+                                const std::vector<TimePoint>& depthTime) {
+    nodes += searchNodes;
+    time += searchTime;
+
+    if (depthTime.size() > timeToDepth.size())
+    {
+        timeToDepth.resize(depthTime.size());
+        positionsAtDepth.resize(depthTime.size());
+    }
+
+    // Depths that were not completed are negative
+    for (size_t d = 1; d < depthTime.size(); ++d)
+        if (depthTime[d] >= 0)
+        {
+            timeToDepth[d] += depthTime[d];
+            positionsAtDepth[d]++;
+        }
+}
+
+std::string format_search_ab(const std::vector<SearchABResult>& results) {
+
+    std::stringstream ss;
+
+    auto row = [&](const std::string& name, auto value) {
+        ss << '\n' << std::left << std::setw(27) << name << ':' << std::right;
+        for (const SearchABResult& r : results)
+            ss << std::setw(14) << value(r);
+    };
+
+    size_t maxDepth = 0;
+    for (const SearchABResult& r : results)
+        maxDepth = std::max(maxDepth, r.timeToDepth.size());
+
+    ss << "===========================";
+
+    row("Backend", [](const SearchABResult& r) { return r.backend; });
+    row("Nodes searched", [](const SearchABResult& r) { return r.nodes; });
+    row("Total search time [ms]", [](const SearchABResult& r) { return r.time; });
+    row("Nodes/second",
+        [](const SearchABResult& r) { return 1000 * r.nodes / std::max<TimePoint>(r.time, 1); });
+
+    // The average over the positions that completed the depth
+    for (size_t d = 1; d < maxDepth; ++d)
+        row("Time to depth " + std::to_string(d) + " [ms]", [d](const SearchABResult& r) {
+            return d < r.timeToDepth.size() && r.positionsAtDepth[d]
+                   ? std::to_string(r.timeToDepth[d] / r.positionsAtDepth[d])
+                   : std::string("-");
+        });
+
+    return ss.str();
+}
+
+std::string format_latencies(const std::string& name, std::vector<int64_t> latencies) {
+
+    std::stringstream ss;
+    ss << std::left << std::setw(27) << name << ':' << std::right;
+
+    if (latencies.empty())
+    {
+        ss << " -";
+        return ss.str();
+    }
+
+    std::sort(latencies.begin(), latencies.end());
+
+    auto percentile = [&](size_t p) { return latencies[(latencies.size() - 1) * p / 100]; };
+
+    ss << " min " << std::setw(7) << latencies.front()  //
+       << "  median " << std::setw(7) << percentile(50)  //
+       << "  p90 " << std::setw(7) << percentile(90)     //
+       << "  p99 " << std::setw(7) << percentile(99)     //
+       << "  max " << std::setw(7) << latencies.back();
+
+    return ss.str();
+}
+
+// Measures the time the main thread spends counting the nodes of all the threads,
+// as check_time() does every 512 nodes, while the threads count nodes as the
+// search does: by reading the counter of each thread, or by reading the counters
+// published for each NUMA node, emulated here as groups of 32 threads.
+std::string node_count_benchmark(size_t maxThreads) {
+
+    constexpr size_t   ThreadsPerNode = 32;
+    constexpr uint64_t Period         = Search::PublishedNodes::PublishPeriod;
+
+    struct alignas(64) ThreadNodes {
+        std::atomic<uint64_t> nodes{0};
+        uint64_t              published = 0;
+    };
+
+    std::stringstream ss;
+    ss << "Node count by the main thread [ns per count]\n"
+       << std::setw(8) << "threads" << std::setw(12) << "per thread" << std::setw(12)
+       << "published" << '\n';
+
+    for (size_t threadCount = 1; threadCount <= maxThreads; threadCount *= 2)
+    {
+        std::vector<ThreadNodes>            counters(threadCount);
+        std::vector<Search::PublishedNodes> published((threadCount - 1) / ThreadsPerNode + 1);
+        std::vector<std::thread>            threads;
+        std::atomic_bool                    stop{false};
+        std::atomic<uint64_t>               sink{0};  // Keeps the work from being optimized out
+
+        // Some work between the nodes, so that they are counted about as often as in a search
+        for (size_t t = 1; t < threadCount; ++t)
+            threads.emplace_back([&, t]() {
+                ThreadNodes&            c    = counters[t];
+                Search::PublishedNodes& node = published[t / ThreadsPerNode];
+                uint64_t                x    = t;
+
+                while (!stop.load(std::memory_order_relaxed))
+                {
+                    for (int i = 0; i < 256; ++i)
+                        x = x * 6364136223846793005ULL + 1442695040888963407ULL;
+
+                    if ((c.nodes.fetch_add(1, std::memory_order_relaxed) & (Period - 1))
+                        == Period - 1)
+                    {
+                        const uint64_t n = c.nodes.load(std::memory_order_relaxed);
+                        node.nodes.fetch_add(n - c.published, std::memory_order_relaxed);
+                        c.published = n;
+                    }
+                }
+
+                sink += x;
+            });
+
+        // The median, as the main thread may be preempted by the others
+        auto measure = [&](auto count) {
+            using Clock = std::chrono::steady_clock;
+
+            std::vector<Clock::duration> times;
+            uint64_t                     sum = 0;
+            const auto                   end = Clock::now() + std::chrono::milliseconds(200);
+
+            while (Clock::now() < end)
+            {
+                const auto start = Clock::now();
+                sum += count();
+                times.push_back(Clock::now() - start);
+                counters[0].nodes.fetch_add(512, std::memory_order_relaxed);
+            }
+
+            sink += sum;
+            std::nth_element(times.begin(), times.begin() + times.size() / 2, times.end());
+            return std::chrono::duration_cast<std::chrono::nanoseconds>(times[times.size() / 2])
+              .count();
+        };
+
+        const auto perThread = measure([&]() {
+            uint64_t sum = 0;
+            for (auto& c : counters)
+                sum += c.nodes.load(std::memory_order_relaxed);
+            return sum;
+        });
+
+        const auto perNode = measure([&]() {
+            uint64_t sum = counters[0].nodes.load(std::memory_order_relaxed) - counters[0].published;
+            for (auto& node : published)
+                sum += node.nodes.load(std::memory_order_relaxed);
+            return sum;
+        });
+
+        stop = true;
+        for (auto& th : threads)
+            th.join();
+
+        ss << std::setw(8) << threadCount << std::setw(12) << perThread << std::setw(12) << perNode
+           << '\n';
+    }
+
+    return ss.str();
+}
+
+// Measures the time per move of the accumulator updates of the big net, with the
+// piece-square and threat updates done in separate passes and in one pass, over
+// the tree of the given depth. The time of the walk alone is subtracted.
+std::string accumulator_update_benchmark(const Eval::NNUE::Networks& networks,
+                                         const std::string&          fen,
+                                         bool                        isChess960,
+                                         Depth                       depth) {
+
+    auto stack  = std::make_unique<Eval::NNUE::AccumulatorStack>();
+    auto caches = std::make_unique<Eval::NNUE::AccumulatorCaches>(networks);
+
+    StateInfo st;
+    Position  pos;
+    pos.set(fen, isChess960, &st);
+
+    auto run = [&](auto walk, bool fuse) {
+        stack->reset();
+        networks.big.update_accumulators(pos, *stack, caches->big, fuse);
+
+        const auto     start = std::chrono::steady_clock::now();
+        const uint64_t moves = walk(pos, depth, networks, *stack, *caches, fuse);
+        const auto     end   = std::chrono::steady_clock::now();
+
+        return std::make_pair(
+          moves, double(std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count()));
+    };
+
+    // After one warm-up run of each, the runs alternate in turns where each of
+    // them comes first in every other turn, so that neither always finds the
+    // caches left by the other. The fastest run of each is kept.
+    constexpr int Turns = 6;
+
+    run(walk_accumulators<true>, false);
+    run(walk_accumulators<true>, true);
+
+    uint64_t moves    = 0;
+    double   walkTime = std::numeric_limits<double>::max();
+    double   separate = std::numeric_limits<double>::max();
+    double   fused    = std::numeric_limits<double>::max();
+
+    for (int turn = 0; turn < Turns; ++turn)
+    {
+        const auto walk = run(walk_accumulators<false>, false);
+        moves           = walk.first;
+        walkTime        = std::min(walkTime, walk.second);
+
+        const bool fusedFirst = turn % 2;
+        for (bool fuse : {fusedFirst, !fusedFirst})
+        {
+            double& best = fuse ? fused : separate;
+            best         = std::min(best, run(walk_accumulators<true>, fuse).second);
+        }
+    }
+
+    std::stringstream ss;
+    ss << "Accumulator updates of the big net to depth " << depth << ", " << moves
+       << " moves [ns per move]" << std::fixed << std::setprecision(1)
+       << "\nseparate passes : " << (separate - walkTime) / moves
+       << "\none pass        : " << (fused - walkTime) / moves;
+
+    return ss.str();
+}
+
+// Times each stage of the evaluation of both networks, from the accumulator
+// updates to the last layer, over short game lines from the bench positions.
+// The cycles are ticks of the time stamp counter, where it can be read.
+std::string nnue_benchmark(const Eval::NNUE::Networks& networks, int rounds) {
+
+    std::vector<std::string> fens;
+    for (const auto& fen : Defaults)
+    {
+        if (fen.find("UCI_Chess960 value true") != std::string::npos)
+            break;
+        if (fen.find("setoption") == std::string::npos)
+            fens.push_back(fen);
+    }
+
+    auto caches = std::make_unique<Eval::NNUE::AccumulatorCaches>(networks);
+
+    std::string simd;
+#if defined(USE_AVX512ICL)
+    simd += " AVX512ICL";
+#endif
+#if defined(USE_VNNI)
+    simd += " VNNI";
+#endif
+#if defined(USE_AVX512)
+    simd += " AVX512";
+#endif
+#if defined(USE_AVX2)
+    simd += " AVX2";
+#endif
+#if defined(USE_SSSE3)
+    simd += " SSSE3";
+#endif
+#if defined(USE_NEON_DOTPROD)
+    simd += " NEON_DOTPROD";
+#endif
+#if defined(USE_NEON)
+    simd += " NEON";
+#endif
+
+    std::stringstream ss;
+    ss << "NNUE evaluation stages over " << fens.size() << " positions and their lines, "
+       << rounds << " rounds\nSIMD:" << (simd.empty() ? " none" : simd) << std::fixed
+       << std::setprecision(1);
+
+    auto report = [&](const char* name, const std::vector<StageTime>& stages) {
+        ss << "\n\n"
+           << std::left << std::setw(27) << name << std::right << std::setw(12) << "ns/call"
+           << std::setw(14) << "cycles/call";
+
+        for (const auto& stage : stages)
+        {
+            ss << '\n' << std::left << std::setw(27) << stage.name << std::right;
+
+            if (!stage.calls)
+            {
+                ss << std::setw(12) << '-' << std::setw(14) << '-';
+                continue;
+            }
+
+            ss << std::setw(12) << double(stage.ns) / stage.calls << std::setw(14);
+
+            if (stage.ticks)
+                ss << double(stage.ticks) / stage.calls;
+            else
+                ss << '-';
+        }
+    };
+
+    report("big net", time_network_stages(networks.big, caches->big, fens, rounds));
+    report("small net", time_network_stages(networks.small, caches->small, fens, rounds));
+
+    return ss.str();
+}
+
+// Compares the make/unmake throughput of do_move(), which also collects the
+// changed pieces and threats for NNUE, to the one of do_light_move(). Both walk
+// the same tree, so the move generation costs the same for both.
+std::string make_move_benchmark(const std::string& fen, bool isChess960, Depth depth) {
+
+    StateInfo st;
+    Position  pos;
+    pos.set(fen, isChess960, &st);
+
+    std::stringstream ss;
+    ss << "Make/unmake throughput to depth " << depth << " [million moves/s]" << std::fixed
+       << std::setprecision(1);
+
+    auto run = [&](const char* name, auto makeUnmake) {
+        const TimePoint start   = now();
+        const uint64_t  moves   = makeUnmake(pos, depth);
+        const TimePoint elapsed = std::max<TimePoint>(now() - start, 1);
+
+        ss << '\n' << std::left << std::setw(12) << name << ": " << double(moves) / elapsed / 1000
+           << " (" << moves << " moves in " << elapsed << " ms)";
+    };
+
+    run("do_move", make_unmake<false>);
+    run("light move", make_unmake<true>);
+
+    return ss.str();
+}
+
 }  // namespace Stockfish
@@ -19,10 +19,18 @@
 #ifndef BENCHMARK_H_INCLUDED
 #define BENCHMARK_H_INCLUDED
 
+#include <cstdint>
 #include <iosfwd>
 #include <string>
 #include <vector>
 
+#include "misc.h"
+#include "types.h"
+
+namespace Stockfish::Eval::NNUE {
+struct Networks;
+}
+
 namespace Stockfish::Benchmark {
 
 std::vector<std::string> setup_bench(const std::string&, std::istream&);
@@ -37,6 +45,40 @@ struct BenchmarkSetup {
 
 BenchmarkSetup setup_benchmark(std::istream&);
 
+std::vector<std::string> setup_search_ab(const std::string&, std::istream&);
+
+// Totals of one search backend over the positions of the A/B comparison
+struct SearchABResult {
+    std::string backend;
+    uint64_t    nodes = 0;
+    TimePoint   time  = 0;
+
+    // Indexed by depth, summed over the positions that completed the depth
+    std::vector<TimePoint> timeToDepth;
+    std::vector<int>       positionsAtDepth;
+
+    void add_search(uint64_t                      searchNodes,
+                    TimePoint                     searchTime,
+                    const std::vector<TimePoint>& depthTime);
+};
+
+std::string format_search_ab(const std::vector<SearchABResult>&);
+
+// Distribution of latencies in microseconds, as the minimum, the median, the
+// 90th and 99th percentiles and the maximum
+std::string format_latencies(const std::string& name, std::vector<int64_t> latencies);
+
+std::string node_count_benchmark(size_t maxThreads);
+
+std::string accumulator_update_benchmark(const Eval::NNUE::Networks& networks,
+                                         const std::string&          fen,
+                                         bool                        isChess960,
+                                         Depth                       depth);
+
+std::string make_move_benchmark(const std::string& fen, bool isChess960, Depth depth);
+
+std::string nnue_benchmark(const Eval::NNUE::Networks& networks, int rounds);
+
 }  // namespace Stockfish
 
 #endif  // #ifndef BENCHMARK_H_INCLUDED
@@ -0,0 +1,287 @@
+/*
+  Capablanca Chess Engine - C API
+  Copyright (C) 2025 Capablanca Chess Engine Team
+
+  This file implements the C interface of capi.h over the Engine class.
+*/
+
+#include "capi.h"
+
+#include <climits>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <optional>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "bitboard.h"
+#include "engine.h"
+#include "evaluate.h"
+#include "misc.h"
+#include "nnue/features/full_threats.h"
+#include "position.h"
+#include "score.h"
+#include "search.h"
+#include "types.h"
+#include "uci.h"
+#include "ucioption.h"
+
+using namespace Stockfish;
+
+struct capa_host {
+    capa_host(const char* binaryPath, size_t maxThreads) :
+        host(binaryPath ? std::optional<std::string>(binaryPath) : std::nullopt, maxThreads) {}
+
+    EngineHost host;
+};
+
+struct capa_engine {
+    explicit capa_engine(const char* binaryPath) :
+        engine(binaryPath ? std::optional<std::string>(binaryPath) : std::nullopt) {}
+    explicit capa_engine(capa_host* h) :
+        engine(h->host) {}
+
+    Engine engine;
+
+    capa_info_callback     onInfo     = nullptr;
+    capa_bestmove_callback onBestmove = nullptr;
+    capa_message_callback  onMessage  = nullptr;
+    void*                  infoUser = nullptr, *bestmoveUser = nullptr, *messageUser = nullptr;
+};
+
+namespace {
+
+std::once_flag initFlag;
+
+// The tables of the engine are global, and initialized once for all the engines
+void init_once() {
+    std::call_once(initFlag, []() {
+        Bitboards::init();
+        Position::init();
+        Eval::NNUE::Features::init_threat_offsets();
+    });
+}
+
+void message(capa_engine* e, std::string_view str) {
+    if (e->onMessage)
+        e->onMessage(e->messageUser, std::string(str).c_str());
+}
+
+capa_info to_info(const Engine::InfoFull& i) {
+    capa_info info{};
+
+    info.depth    = i.depth;
+    info.selDepth = i.selDepth;
+    info.multiPV  = i.multiPV;
+    info.timeMs   = i.timeMs;
+    info.nodes    = i.nodes;
+    info.nps      = i.nps;
+    info.tbHits   = i.tbHits;
+    info.hashfull = i.hashfull;
+    info.bound    = i.bound == "lowerbound"   ? CAPA_BOUND_LOWER
+                  : i.bound == "upperbound" ? CAPA_BOUND_UPPER
+                                            : CAPA_BOUND_EXACT;
+
+    if (i.score.is<Score::Mate>())
+    {
+        const int plies = i.score.get<Score::Mate>().plies;
+        info.scoreKind  = CAPA_SCORE_MATE;
+        info.score      = (plies > 0 ? (plies + 1) : plies) / 2;
+    }
+    else if (i.score.is<Score::Tablebase>())
+    {
+        info.scoreKind = CAPA_SCORE_TB;
+        info.score     = i.score.get<Score::Tablebase>().plies;
+    }
+    else
+    {
+        info.scoreKind = CAPA_SCORE_CP;
+        info.score     = i.score.get<Score::InternalUnits>().value;
+    }
+
+    std::istringstream wdl{std::string(i.wdl)};
+    wdl >> info.wdl[0] >> info.wdl[1] >> info.wdl[2];
+
+    return info;
+}
+
+// Sets the listeners of a new engine
+capa_engine* setup(capa_engine* e) {
+    if (!e)
+        return nullptr;
+
+    // The search calls all of its listeners, so each one is set even when the
+    // matching C callback is not.
+    e->engine.get_options().add_info_listener([e](const std::optional<std::string>& str) {
+        if (str.has_value())
+            message(e, *str);
+    });
+    e->engine.set_on_iter([](const auto&) {});
+    e->engine.set_on_update_no_moves([](const auto&) {});
+    e->engine.set_on_update_full([e](const auto& i) {
+        if (!e->onInfo)
+            return;
+
+        const std::string pv(i.pv);
+        capa_info         info = to_info(i);
+        info.pv                = pv.c_str();
+        e->onInfo(e->infoUser, &info);
+    });
+    e->engine.set_on_bestmove([e](std::string_view bestmove, std::string_view ponder) {
+        if (e->onBestmove)
+            e->onBestmove(e->bestmoveUser, std::string(bestmove).c_str(),
+                          std::string(ponder).c_str());
+    });
+    e->engine.set_on_verify_networks([e](std::string_view str) { message(e, str); });
+
+    return e;
+}
+
+}  // namespace
+
+
+extern "C" {
+
+int capa_api_version(void) { return CAPA_API_VERSION; }
+
+capa_engine* capa_engine_new(const char* binaryPath) {
+    init_once();
+    return setup(new (std::nothrow) capa_engine(binaryPath));
+}
+
+void capa_engine_free(capa_engine* e) { delete e; }
+
+capa_host* capa_host_new(const char* binaryPath, size_t maxThreads) {
+    init_once();
+    return new (std::nothrow) capa_host(binaryPath, maxThreads);
+}
+
+void capa_host_free(capa_host* h) { delete h; }
+
+capa_engine* capa_engine_new_on_host(capa_host* h) {
+    return h ? setup(new (std::nothrow) capa_engine(h)) : nullptr;
+}
+
+int capa_set_option(capa_engine* e, const char* name, const char* value) {
+    if (!e || !name || !value)
+        return CAPA_ERROR_INVALID_ARGUMENT;
+
+    if (!e->engine.get_options().count(name))
+        return CAPA_ERROR_NO_SUCH_OPTION;
+
+    std::istringstream is("name " + std::string(name) + " value " + value);
+
+    e->engine.wait_for_search_finished();
+    e->engine.get_options().setoption(is);
+    return CAPA_OK;
+}
+
+void capa_set_info_callback(capa_engine* e, capa_info_callback cb, void* user) {
+    if (!e)
+        return;
+
+    e->onInfo   = cb;
+    e->infoUser = user;
+}
+
+void capa_set_bestmove_callback(capa_engine* e, capa_bestmove_callback cb, void* user) {
+    if (!e)
+        return;
+
+    e->onBestmove   = cb;
+    e->bestmoveUser = user;
+}
+
+void capa_set_message_callback(capa_engine* e, capa_message_callback cb, void* user) {
+    if (!e)
+        return;
+
+    e->onMessage   = cb;
+    e->messageUser = user;
+}
+
+int capa_set_position(capa_engine* e, const char* fen, const char* const* moves, size_t movesCount) {
+    if (!e || (movesCount && !moves))
+        return CAPA_ERROR_INVALID_ARGUMENT;
+
+    constexpr auto StartFEN = "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1";
+
+    e->engine.wait_for_search_finished();
+    e->engine.set_position(fen ? fen : StartFEN,
+                           std::vector<std::string>(moves, moves + movesCount));
+    return CAPA_OK;
+}
+
+int capa_go(capa_engine* e, const capa_limits* l) {
+    if (!e || !l || (l->searchmovesCount && !l->searchmoves))
+        return CAPA_ERROR_INVALID_ARGUMENT;
+
+    Search::LimitsType limits;
+
+    limits.startTime = now();  // The search starts as early as possible
+
+    limits.searchmoves.assign(l->searchmoves, l->searchmoves + l->searchmovesCount);
+    limits.time[WHITE] = l->wtime;
+    limits.time[BLACK] = l->btime;
+    limits.inc[WHITE]  = l->winc;
+    limits.inc[BLACK]  = l->binc;
+    limits.movetime    = l->movetime;
+    limits.movestogo   = l->movestogo;
+    limits.depth       = l->depth;
+    limits.mate        = l->mate;
+    limits.nodes       = l->nodes;
+    limits.infinite    = l->infinite;
+    limits.ponderMode  = l->ponder;
+
+    for (auto& m : limits.searchmoves)
+        m = UCIEngine::to_lower(m);
+
+    e->engine.go(limits);
+    return CAPA_OK;
+}
+
+void capa_stop(capa_engine* e) {
+    if (e)
+        e->engine.stop();
+}
+
+void capa_ponderhit(capa_engine* e) {
+    if (e)
+        e->engine.set_ponderhit(false);
+}
+
+void capa_wait(capa_engine* e) {
+    if (e)
+        e->engine.wait_for_search_finished();
+}
+
+void capa_new_game(capa_engine* e) {
+    if (e)
+        e->engine.search_clear(true);
+}
+
+int capa_eval(capa_engine* e, const char* const* fens, size_t count, int net, int32_t* values) {
+    if (!e || (count && (!fens || !values)) || net < CAPA_NET_AUTO || net > CAPA_NET_BIG)
+        return CAPA_ERROR_INVALID_ARGUMENT;
+
+    // Position::set() trusts its input
+    for (size_t i = 0; i < count; ++i)
+        if (!fens[i] || Position::fen_error(fens[i]))
+            return CAPA_ERROR_INVALID_ARGUMENT;
+
+    const auto selection = net == CAPA_NET_SMALL ? Eval::NetSelection::Small
+                         : net == CAPA_NET_BIG   ? Eval::NetSelection::Big
+                                                 : Eval::NetSelection::Auto;
+
+    const std::vector<Value> v =
+      e->engine.evaluate(std::vector<std::string>(fens, fens + count), selection);
+
+    for (size_t i = 0; i < count; ++i)
+        values[i] = v[i] == VALUE_NONE ? INT32_MIN : v[i];
+
+    return CAPA_OK;
+}
+
+}  // extern "C"
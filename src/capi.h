@@ -0,0 +1,159 @@
+/*
+  Capablanca Chess Engine - C API
+  Copyright (C) 2025 Capablanca Chess Engine Team
+
+  This file declares the C interface of libcapablanca.so, built with
+  'make libcapablanca.so'. It drives the engine directly, without the UCI
+  text layer, so that a service can embed one or more engines in its own
+  process and get the search results as structures.
+
+  The header is plain C. All the strings are UTF-8 and null terminated, and
+  the strings passed to a callback are only valid during the call.
+*/
+
+#ifndef CAPI_H_INCLUDED
+#define CAPI_H_INCLUDED
+
+#include <stddef.h>
+#include <stdint.h>
+
+#if defined(_WIN32)
+    #define CAPA_API __declspec(dllexport)
+#else
+    #define CAPA_API __attribute__((visibility("default")))
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Increased whenever a structure or a function changes in an incompatible way
+#define CAPA_API_VERSION 1
+
+// Return values of the functions that can fail. Those that cannot do nothing
+// when given a NULL engine.
+#define CAPA_OK 0
+#define CAPA_ERROR_INVALID_ARGUMENT (-1)
+#define CAPA_ERROR_NO_SUCH_OPTION (-2)
+
+typedef struct capa_engine capa_engine;
+typedef struct capa_host   capa_host;
+
+// The limits of a search, as the arguments of the UCI 'go' command. A zeroed
+// structure is an infinite search. The times are in milliseconds.
+typedef struct {
+    int64_t            wtime, btime, winc, binc;
+    int64_t            movetime;
+    int                movestogo;
+    int                depth;
+    int                mate;
+    uint64_t           nodes;
+    int                infinite;
+    int                ponder;
+    const char* const* searchmoves;  // Moves in UCI notation, or NULL
+    size_t             searchmovesCount;
+} capa_limits;
+
+// The kinds of score, following the Score class of the engine
+enum {
+    CAPA_SCORE_CP,    // value in centipawns
+    CAPA_SCORE_MATE,  // value in moves, negative when getting mated
+    CAPA_SCORE_TB     // value in plies to a tablebase win or, when negative, loss
+};
+
+// The bound of a score, CAPA_BOUND_EXACT unless the search failed high or low
+enum {
+    CAPA_BOUND_EXACT,
+    CAPA_BOUND_LOWER,
+    CAPA_BOUND_UPPER
+};
+
+// The information of a completed iteration, as an UCI 'info' line
+typedef struct {
+    int         depth;
+    int         selDepth;
+    size_t      multiPV;
+    int         scoreKind;
+    int         score;
+    int         bound;
+    int         wdl[3];  // Win, draw and loss per mille, only set with UCI_ShowWDL
+    uint64_t    timeMs;
+    uint64_t    nodes;
+    uint64_t    nps;
+    uint64_t    tbHits;
+    int         hashfull;
+    const char* pv;  // Moves in UCI notation, separated by spaces
+} capa_info;
+
+typedef void (*capa_info_callback)(void* user, const capa_info* info);
+typedef void (*capa_bestmove_callback)(void* user, const char* bestmove, const char* ponder);
+typedef void (*capa_message_callback)(void* user, const char* message);
+
+// The network evaluating a position with capa_eval()
+enum {
+    CAPA_NET_AUTO,  // the static evaluation of the engine
+    CAPA_NET_SMALL,
+    CAPA_NET_BIG
+};
+
+CAPA_API int capa_api_version(void);
+
+// Creates an engine with the default options, at the start position. binaryPath
+// is where the engine looks for the network files, it can be NULL. Several
+// engines can live in one process, but the Syzygy tablebases are shared.
+CAPA_API capa_engine* capa_engine_new(const char* binaryPath);
+CAPA_API void         capa_engine_free(capa_engine* engine);
+
+// Creates a host for many engines, loading the networks once. The engines created
+// on it share its networks, and search with at most maxThreads threads in total,
+// 0 for no limit: a search waits for the threads of the others to be free. The
+// host must be freed after all its engines.
+CAPA_API capa_host*   capa_host_new(const char* binaryPath, size_t maxThreads);
+CAPA_API void         capa_host_free(capa_host* host);
+CAPA_API capa_engine* capa_engine_new_on_host(capa_host* host);
+
+// Sets an UCI option, as the 'setoption' command. Waits for a running search.
+CAPA_API int capa_set_option(capa_engine* engine, const char* name, const char* value);
+
+// The callbacks are called from the search threads. They are not to be changed
+// while searching. info is called for each completed iteration, bestmove once
+// at the end of each search, and message for the information strings that the
+// UCI layer would output, about the networks and the options.
+CAPA_API void capa_set_info_callback(capa_engine* engine, capa_info_callback cb, void* user);
+CAPA_API void
+capa_set_bestmove_callback(capa_engine* engine, capa_bestmove_callback cb, void* user);
+CAPA_API void capa_set_message_callback(capa_engine* engine, capa_message_callback cb, void* user);
+
+// Sets the position from a FEN, NULL for the start position, and plays the moves
+// in UCI notation. The moves after an illegal one are ignored.
+CAPA_API int capa_set_position(capa_engine*       engine,
+                               const char*        fen,
+                               const char* const* moves,
+                               size_t             movesCount);
+
+// Starts searching the position, and returns immediately. The bestmove callback
+// is called when the search is done. On a host, the search first waits for free
+// threads of the budget, capa_stop cancels it while it waits.
+CAPA_API int  capa_go(capa_engine* engine, const capa_limits* limits);
+CAPA_API void capa_stop(capa_engine* engine);
+CAPA_API void capa_ponderhit(capa_engine* engine);
+CAPA_API void capa_wait(capa_engine* engine);
+
+// Clears the hash and the histories, as 'ucinewgame'
+CAPA_API void capa_new_game(capa_engine* engine);
+
+// Static evaluations of the positions, from the side to move and in internal
+// units, computed on all the threads of the engine. INT32_MIN when the side to
+// move is in check. Waits for a running search. Fails with
+// CAPA_ERROR_INVALID_ARGUMENT, evaluating nothing, if a FEN is not valid.
+CAPA_API int capa_eval(capa_engine*       engine,
+                       const char* const* fens,
+                       size_t             count,
+                       int                net,
+                       int32_t*           values);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // #ifndef CAPI_H_INCLUDED
@@ -20,7 +20,9 @@
 
 #include <algorithm>
 #include <cassert>
+#include <chrono>
 #include <deque>
+#include <iomanip>
 #include <iosfwd>
 #include <memory>
 #include <ostream>
@@ -29,6 +31,7 @@
 #include <utility>
 #include <vector>
 
+#include "benchmark.h"
 #include "evaluate.h"
 #include "misc.h"
 #include "nnue/network.h"
@@ -52,11 +55,9 @@ constexpr auto StartFEN   = "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq
 constexpr int  MaxHashMB  = Is64Bit ? 33554432 : 2048;
 int            MaxThreads = std::max(1024, 4 * int(get_hardware_concurrency()));
 
-Engine::Engine(std::optional<std::string> path) :
+EngineHost::EngineHost(std::optional<std::string> path, size_t maxThreadCount) :
     binaryDirectory(path ? CommandLine::get_binary_directory(*path) : ""),
     numaContext(NumaConfig::from_system()),
-    states(new std::deque<StateInfo>(1)),
-    threads(),
     networks(
       numaContext,
       // Heap-allocate because sizeof(NN::Networks) is large
@@ -64,7 +65,61 @@ Engine::Engine(std::optional<std::string> path) :
         std::make_unique<NN::NetworkBig>(NN::EvalFile{EvalFileDefaultNameBig, "None", ""},
                                          NN::EmbeddedNNUEType::BIG),
         std::make_unique<NN::NetworkSmall>(NN::EvalFile{EvalFileDefaultNameSmall, "None", ""},
-                                           NN::EmbeddedNNUEType::SMALL))) {
+                                           NN::EmbeddedNNUEType::SMALL))),
+    maxThreads(maxThreadCount) {
+
+    networks.modify_and_replicate([this](NN::Networks& networks_) {
+        networks_.big.load(binaryDirectory, EvalFileDefaultNameBig);
+        networks_.small.load(binaryDirectory, EvalFileDefaultNameSmall);
+    });
+}
+
+size_t EngineHost::acquire_threads(size_t count, const std::atomic_bool* stop) {
+    if (!maxThreads)
+        return 0;
+
+    count = std::min(count, maxThreads);
+
+    std::unique_lock<std::mutex> lk(mutex);
+    threadsFreed.wait(lk, [&] { return busyThreads + count <= maxThreads || (stop && *stop); });
+    if (busyThreads + count > maxThreads)
+        return 0;
+
+    busyThreads += count;
+    return count;
+}
+
+void EngineHost::release_threads(size_t count) {
+    if (!count)
+        return;
+
+    {
+        std::lock_guard<std::mutex> lk(mutex);
+        busyThreads -= count;
+    }
+    threadsFreed.notify_all();
+}
+
+void EngineHost::wake_waiting() {
+    // Under the lock, so that a search cannot miss the wake up between checking
+    // its stop flag and waiting
+    {
+        std::lock_guard<std::mutex> lk(mutex);
+    }
+    threadsFreed.notify_all();
+}
+
+Engine::Engine(std::optional<std::string> path) :
+    Engine(nullptr, path) {}
+
+Engine::Engine(EngineHost& sharedHost) :
+    Engine(&sharedHost, std::nullopt) {}
+
+Engine::Engine(EngineHost* sharedHost, std::optional<std::string> path) :
+    ownHost(sharedHost ? nullptr : std::make_unique<EngineHost>(path)),
+    host(sharedHost ? *sharedHost : *ownHost),
+    states(new std::deque<StateInfo>(1)),
+    threads() {
 
     pos.set(StartFEN, false, &states->back());
 
@@ -75,16 +130,23 @@ Engine::Engine(std::optional<std::string> path) :
       }));
 
     options.add(  //
-      "NumaPolicy", Option("auto", [this](const Option& o) {
+      "NumaPolicy", Option("auto", [this](const Option& o) -> std::optional<std::string> {
+          if (!ownHost)
+              return "The NUMA configuration is the one of the engine host";
+
           set_numa_config_from_option(o);
           return numa_config_information_as_string() + "\n"
                + thread_allocation_information_as_string();
       }));
 
     options.add(  //
-      "Threads", Option(1, 1, MaxThreads, [this](const Option&) {
+      "Threads", Option(1, 1, MaxThreads, [this](const Option& o) {
           resize_threads();
-          return thread_allocation_information_as_string();
+          std::string info = thread_allocation_information_as_string();
+          if (host.maxThreads && size_t(int(o)) > host.maxThreads)
+              info = "Threads limited to the " + std::to_string(host.maxThreads)
+                   + " threads of the engine host\n" + info;
+          return info;
       }));
 
     options.add(  //
@@ -93,12 +155,66 @@ Engine::Engine(std::optional<std::string> path) :
           return std::nullopt;
       }));
 
+    // The entries kept in the file by a previous run survive the first
+    // ucinewgame, as sent at startup. Clear Hash wipes them.
+    options.add(  //
+      "HashFile", Option("", [this](const Option& o) -> std::optional<std::string> {
+          set_tt_size(options["Hash"]);
+          if (!std::string(o).empty() && !tt.is_file_backed())
+              return "Failed to map " + std::string(o) + ", the hash uses anonymous memory";
+          return std::nullopt;
+      }));
+
+    options.add(  //
+      "SharedHash", Option("", [this](const Option& o) -> std::optional<std::string> {
+          set_tt_size(options["Hash"]);
+          if (!std::string(o).empty() && !tt.is_shared())
+              return "Failed to share the hash as " + std::string(o)
+                   + ", the hash is private to this process";
+          return std::nullopt;
+      }));
+
+    options.add(  //
+      "HashNumaPlacement",
+      Option("auto var auto var interleave var partition", "auto", [this](const Option&) {
+          set_tt_size(options["Hash"]);
+          return std::nullopt;
+      }));
+
+    options.add(  //
+      "HashFormat", Option("compact var compact var wide", "compact", [this](const Option&) {
+          set_tt_size(options["Hash"]);
+          return std::nullopt;
+      }));
+
+    options.add(  //
+      "HashStats", Option(false));
+
+    // Size in MiB of the evaluation cache of each thread, 0 disables it. Off by
+    // default, as the static evals of transpositions already come from the TT.
+    options.add(  //
+      "EvalCache", Option(0, 0, 1024));
+
+    // The v3 backend is experimental, compare it to the classic search with bench_ab
+    options.add(  //
+      "SearchBackend", Option("classic var classic var v3", "classic"));
+
     options.add(  //
       "Clear Hash", Option([this](const Option&) {
           search_clear();
           return std::nullopt;
       }));
 
+    // Stop the search at the time limit from a timer thread, rather than only
+    // at the time checks of the main thread
+    options.add(  //
+      "TimerThread", Option(false));
+
+    // Prefetch in do_move() the network weights that the next evaluation of the
+    // position is to read
+    options.add(  //
+      "PrefetchWeights", Option(false));
+
     options.add(  //
       "Ponder", Option(false));
 
@@ -134,39 +250,93 @@ Engine::Engine(std::optional<std::string> path) :
     options.add("SyzygyProbeLimit", Option(7, 0, 7));
 
     options.add(  //
-      "EvalFile", Option(EvalFileDefaultNameBig, [this](const Option& o) {
+      "EvalFile", Option(EvalFileDefaultNameBig, [this](const Option& o) -> std::optional<std::string> {
+          if (!ownHost)
+              return "The networks are the ones of the engine host";
+
           load_big_network(o);
           return std::nullopt;
       }));
 
     options.add(  //
-      "EvalFileSmall", Option(EvalFileDefaultNameSmall, [this](const Option& o) {
+      "EvalFileSmall", Option(EvalFileDefaultNameSmall, [this](const Option& o) -> std::optional<std::string> {
+          if (!ownHost)
+              return "The networks are the ones of the engine host";
+
           load_small_network(o);
           return std::nullopt;
       }));
 
-    load_networks();
+    // Taken by the main search thread, so that go returns at once and a search
+    // waiting for the budget can be stopped
+    updateContext.onSearchStart = [this] {
+        searchThreads = host.acquire_threads(threads.num_threads(), &threads.stop);
+    };
+
+    // The networks are loaded by the host
     resize_threads();
 }
 
-std::uint64_t Engine::perft(const std::string& fen, Depth depth, bool isChess960) {
+std::uint64_t Engine::perft(
+  const std::string& fen, Depth depth, bool isChess960, size_t threadCount, size_t hashMb) {
     verify_networks();
+    wait_for_search_finished();
 
-    return Benchmark::perft(fen, depth, isChess960);
+    const size_t poolSize = threads.num_threads();
+    threadCount           = threadCount ? std::min(threadCount, poolSize) : poolSize;
+
+    const size_t  taken = host.acquire_threads(threadCount);
+    std::uint64_t nodes = Benchmark::perft(fen, depth, isChess960, threads, threadCount, hashMb);
+    host.release_threads(taken);
+    return nodes;
 }
 
 void Engine::go(Search::LimitsType& limits) {
     assert(limits.perft == 0);
     verify_networks();
+    wait_for_search_finished();
 
+    // The threads are taken from the host by the search, and given back when it
+    // outputs its best move
     threads.start_thinking(options, pos, states, limits);
 }
-void Engine::stop() { threads.stop = true; }
+void Engine::stop() {
+    threads.stop = true;
+    host.wake_waiting();
+}
 
-void Engine::search_clear() {
+void Engine::analyze(const std::vector<std::string>&                                   fens,
+                     const Search::LimitsType&                                         limits,
+                     const std::function<void(size_t, const Search::AnalysisResult&)>& onResult) {
+    verify_networks();
     wait_for_search_finished();
 
-    tt.clear(threads);
+    // The entries of the whole batch are of the same age
+    tt.new_search();
+
+    const size_t taken = host.acquire_threads(threads.num_threads());
+    threads.analyze(options, fens, options["UCI_Chess960"], limits, onResult);
+    host.release_threads(taken);
+}
+
+std::vector<Value> Engine::evaluate(const std::vector<std::string>& fens,
+                                    Eval::NetSelection              net) {
+    verify_networks();
+    wait_for_search_finished();
+
+    std::vector<Value> values;
+    const size_t       taken = host.acquire_threads(threads.num_threads());
+    threads.evaluate(fens, options["UCI_Chess960"], net, values);
+    host.release_threads(taken);
+    return values;
+}
+
+void Engine::search_clear(bool newGame) {
+    wait_for_search_finished();
+
+    // A GUI starts with ucinewgame, which would wipe the entries just restored
+    if (!newGame || !tt.keep_for_new_game())
+        tt.clear(threads);
     threads.clear();
 
     // @TODO wont work with multiple instances
@@ -186,7 +356,11 @@ void Engine::set_on_iter(std::function<void(const Engine::InfoIter&)>&& f) {
 }
 
 void Engine::set_on_bestmove(std::function<void(std::string_view, std::string_view)>&& f) {
-    updateContext.onBestmove = std::move(f);
+    updateContext.onBestmove = [this, f = std::move(f)](std::string_view bestmove,
+                                                        std::string_view ponder) {
+        host.release_threads(std::exchange(searchThreads, 0));
+        f(bestmove, ponder);
+    };
 }
 
 void Engine::set_on_verify_networks(std::function<void(std::string_view)>&& f) {
@@ -196,19 +370,61 @@ void Engine::set_on_verify_networks(std::function<void(std::string_view)>&& f) {
 void Engine::wait_for_search_finished() { threads.main_thread()->wait_for_search_finished(); }
 
 void Engine::set_position(const std::string& fen, const std::vector<std::string>& moves) {
-    // Drop the old state and create a new one
-    states = StateListPtr(new std::deque<StateInfo>(1));
-    pos.set(fen, options["UCI_Chess960"], &states->back());
+    const auto start      = std::chrono::steady_clock::now();
+    const bool isChess960 = options["UCI_Chess960"];
+
+    // When the moves extend the ones of the current position, from the same FEN,
+    // only the new ones are played on it. Otherwise drop the old state and create
+    // a new one. The states handed over to the threads by the last search are
+    // extended where they are, unless that search still reads them.
+    const bool extends = fen == positionFen && isChess960 == positionChess960
+                      && moves.size() >= positionMoves.size()
+                      && std::equal(positionMoves.begin(), positionMoves.end(), moves.begin())
+                      && (states || !threads.search_running());
+
+    size_t                 reused = 0;
+    std::deque<StateInfo>* list;
+
+    if (extends)
+    {
+        list   = states ? states.get() : &threads.setup_states();
+        reused = positionMoves.size();
+    }
+    else
+    {
+        states = StateListPtr(new std::deque<StateInfo>(1));
+        list   = states.get();
+        pos.set(fen, isChess960, &states->back());
+
+        positionFen      = fen;
+        positionChess960 = isChess960;
+        positionMoves.clear();
+    }
 
-    for (const auto& move : moves)
+    for (size_t i = reused; i < moves.size(); ++i)
     {
-        auto m = UCIEngine::to_move(pos, move);
+        auto m = UCIEngine::to_move(pos, moves[i]);
 
         if (m == Move::none())
             break;
 
-        states->emplace_back();
-        pos.do_move(m, states->back());
+        list->emplace_back();
+        pos.do_move(m, list->back());
+        positionMoves.push_back(moves[i]);
+    }
+
+    if (reused)
+    {
+        const auto   elapsed = std::chrono::duration_cast<std::chrono::microseconds>(
+                               std::chrono::steady_clock::now() - start)
+                               .count();
+        const size_t played  = positionMoves.size() - reused;
+
+        // Estimated from the time taken by the new moves
+        write_to_log("position: " + std::to_string(reused) + " moves kept, "
+                     + std::to_string(played) + " played in " + std::to_string(elapsed)
+                     + " us, about " + std::to_string(played ? elapsed * reused / played : 0)
+                     + " us saved");
     }
 }
 
@@ -217,20 +433,20 @@ void Engine::set_position(const std::string& fen, const std::vector<std::string>
 void Engine::set_numa_config_from_option(const std::string& o) {
     if (o == "auto" || o == "system")
     {
-        numaContext.set_numa_config(NumaConfig::from_system());
+        host.numaContext.set_numa_config(NumaConfig::from_system());
     }
     else if (o == "hardware")
     {
         // Don't respect affinity set in the system.
-        numaContext.set_numa_config(NumaConfig::from_system(false));
+        host.numaContext.set_numa_config(NumaConfig::from_system(false));
     }
     else if (o == "none")
     {
-        numaContext.set_numa_config(NumaConfig{});
+        host.numaContext.set_numa_config(NumaConfig{});
     }
     else
     {
-        numaContext.set_numa_config(NumaConfig::from_string(o));
+        host.numaContext.set_numa_config(NumaConfig::from_string(o));
     }
 
     // Force reallocation of threads in case affinities need to change.
@@ -240,7 +456,10 @@ void Engine::set_numa_config_from_option(const std::string& o) {
 
 void Engine::resize_threads() {
     threads.wait_for_search_finished();
-    threads.set(numaContext.get_numa_config(), {options, threads, tt, networks}, updateContext);
+    // Never more threads than the budget of the host, which the searches of this
+    // engine take from as a whole
+    threads.set(host.numaContext.get_numa_config(), {options, threads, tt, host.networks},
+                updateContext, host.maxThreads);
 
     // Reallocate the hash with the new threadpool size
     set_tt_size(options["Hash"]);
@@ -249,7 +468,25 @@ void Engine::resize_threads() {
 
 void Engine::set_tt_size(size_t mb) {
     wait_for_search_finished();
-    tt.resize(mb, threads);
+    const auto placement = options["HashNumaPlacement"] == "interleave" ? TTNumaPlacement::Interleave
+                         : options["HashNumaPlacement"] == "partition" ? TTNumaPlacement::Partition
+                                                                       : TTNumaPlacement::Auto;
+
+    const auto format = options["HashFormat"] == "wide" ? TTFormat::Wide : TTFormat::Compact;
+
+    tt.resize(mb, threads,
+              {format, options["HashFile"], options["SharedHash"], placement,
+               &host.numaContext.get_numa_config()});
+}
+
+bool Engine::save_tt(const std::string& file) {
+    wait_for_search_finished();
+    return tt.save(file);
+}
+
+bool Engine::load_tt(const std::string& file) {
+    wait_for_search_finished();
+    return tt.load(file);
 }
 
 void Engine::set_ponderhit(bool b) { threads.main_manager()->ponder = b; }
@@ -257,10 +494,12 @@ void Engine::set_ponderhit(bool b) { threads.main_manager()->ponder = b; }
 // network related
 
 void Engine::verify_networks() const {
-    networks->big.verify(options["EvalFile"], onVerifyNetworks);
-    networks->small.verify(options["EvalFileSmall"], onVerifyNetworks);
+    // The networks of a shared host are the default ones, whatever the options
+    host.networks->big.verify(ownHost ? std::string(options["EvalFile"]) : "", onVerifyNetworks);
+    host.networks->small.verify(ownHost ? std::string(options["EvalFileSmall"]) : "",
+                                onVerifyNetworks);
 
-    auto statuses = networks.get_status_and_errors();
+    auto statuses = host.networks.get_status_and_errors();
     for (size_t i = 0; i < statuses.size(); ++i)
     {
         const auto [status, error] = statuses[i];
@@ -292,35 +531,43 @@ void Engine::verify_networks() const {
 }
 
 void Engine::load_networks() {
-    networks.modify_and_replicate([this](NN::Networks& networks_) {
-        networks_.big.load(binaryDirectory, options["EvalFile"]);
-        networks_.small.load(binaryDirectory, options["EvalFileSmall"]);
+    host.networks.modify_and_replicate([this](NN::Networks& networks_) {
+        networks_.big.load(host.binaryDirectory, options["EvalFile"]);
+        networks_.small.load(host.binaryDirectory, options["EvalFileSmall"]);
     });
     threads.clear();
     threads.ensure_network_replicated();
 }
 
 void Engine::load_big_network(const std::string& file) {
-    networks.modify_and_replicate(
-      [this, &file](NN::Networks& networks_) { networks_.big.load(binaryDirectory, file); });
+    host.networks.modify_and_replicate(
+      [this, &file](NN::Networks& networks_) { networks_.big.load(host.binaryDirectory, file); });
     threads.clear();
     threads.ensure_network_replicated();
 }
 
 void Engine::load_small_network(const std::string& file) {
-    networks.modify_and_replicate(
-      [this, &file](NN::Networks& networks_) { networks_.small.load(binaryDirectory, file); });
+    host.networks.modify_and_replicate(
+      [this, &file](NN::Networks& networks_) { networks_.small.load(host.binaryDirectory, file); });
     threads.clear();
     threads.ensure_network_replicated();
 }
 
 void Engine::save_network(const std::pair<std::optional<std::string>, std::string> files[2]) {
-    networks.modify_and_replicate([&files](NN::Networks& networks_) {
+    host.networks.modify_and_replicate([&files](NN::Networks& networks_) {
         networks_.big.save(files[0].first);
         networks_.small.save(files[1].first);
     });
 }
 
+bool Engine::save_runtime_networks(const std::optional<std::string>& bigFile,
+                                   const std::optional<std::string>& smallFile) const {
+    verify_networks();
+
+    return (bigFile == "" || host.networks->big.save_runtime(bigFile))
+        && (smallFile == "" || host.networks->small.save_runtime(smallFile));
+}
+
 // utility functions
 
 void Engine::trace_eval() const {
@@ -330,7 +577,20 @@ void Engine::trace_eval() const {
 
     verify_networks();
 
-    sync_cout << "\n" << Eval::trace(p, *networks) << sync_endl;
+    sync_cout << "\n" << Eval::trace(p, *host.networks) << sync_endl;
+}
+
+std::string Engine::accumulator_benchmark(Depth depth) const {
+    verify_networks();
+
+    return Benchmark::accumulator_update_benchmark(*host.networks, pos.fen(),
+                                                   options["UCI_Chess960"], depth);
+}
+
+std::string Engine::nnue_benchmark(int rounds) const {
+    verify_networks();
+
+    return Benchmark::nnue_benchmark(*host.networks, rounds);
 }
 
 const OptionsMap& Engine::get_options() const { return options; }
@@ -338,7 +598,10 @@ OptionsMap&       Engine::get_options() { return options; }
 
 std::string Engine::fen() const { return pos.fen(); }
 
-void Engine::flip() { pos.flip(); }
+void Engine::flip() {
+    pos.flip();
+    positionFen.clear();  // The moves no longer extend the position
+}
 
 std::string Engine::visualize() const {
     std::stringstream ss;
@@ -348,9 +611,62 @@ std::string Engine::visualize() const {
 
 int Engine::get_hashfull(int maxAge) const { return tt.hashfull(maxAge); }
 
+std::pair<uint64_t, uint64_t> Engine::get_tt_numa_probes() const {
+    return {threads.tt_local_probes(), threads.tt_remote_probes()};
+}
+
+TTStats Engine::get_tt_stats() const { return threads.tt_stats(); }
+
+EvalCache::Stats Engine::get_eval_cache_stats() const { return threads.eval_cache_stats(); }
+
+std::string Engine::tt_stats_as_string() const {
+    if (!options["HashStats"])
+        return "Hash statistics are not collected, enable them with the HashStats option";
+
+    constexpr const char* DepthNames[TTStats::DepthBuckets] = {
+      "qsearch", "1-4", "5-8", "9-12", "13-16", "17-20", "21-24", "25+"};
+
+    const TTStats  stats = threads.tt_stats();
+    const uint64_t hits  = stats.total_hits();
+
+    auto percent = [](uint64_t n, uint64_t total) {
+        std::stringstream ss;
+        ss << std::fixed << std::setprecision(2) << (total ? 100.0 * n / total : 0.0) << "%";
+        return ss.str();
+    };
+
+    std::stringstream ss;
+
+    ss << "Hash statistics of the last search"
+       << "\nProbes                : " << stats.probes
+       << "\nHits                  : " << hits << " (" << percent(hits, stats.probes) << ")";
+
+    for (int i = 0; i < TTStats::DepthBuckets; ++i)
+        ss << "\n  depth " << std::left << std::setw(14) << DepthNames[i] << ": "
+           << stats.hits[i] << " (" << percent(stats.hits[i], hits) << " of hits)";
+
+    ss << "\nMisses                : " << stats.misses << " ("
+       << percent(stats.misses, stats.probes) << ")"
+       << "\nKey16 aliases         : ";
+
+    // Aliases are only told apart from hits by the wide format
+    if (tt.entry_format() == TTFormat::Wide)
+        ss << stats.aliases << " (" << percent(stats.aliases, stats.probes) << " of probes)";
+    else
+        ss << "unknown with the compact format";
+
+    ss << "\nWrites                : " << stats.writes
+       << "\n  same key overwrites : " << stats.sameKeyOverwrites << " ("
+       << percent(stats.sameKeyOverwrites, stats.writes) << ")"
+       << "\n  deeper replaced     : " << stats.deeperReplacements << " ("
+       << percent(stats.deeperReplacements, stats.writes) << ")";
+
+    return ss.str();
+}
+
 std::vector<std::pair<size_t, size_t>> Engine::get_bound_thread_count_by_numa_node() const {
     auto                                   counts = threads.get_bound_thread_count_by_numa_node();
-    const NumaConfig&                      cfg    = numaContext.get_numa_config();
+    const NumaConfig&                      cfg    = host.numaContext.get_numa_config();
     std::vector<std::pair<size_t, size_t>> ratios;
     NumaIndex                              n = 0;
     for (; n < counts.size(); ++n)
@@ -362,7 +678,7 @@ std::vector<std::pair<size_t, size_t>> Engine::get_bound_thread_count_by_numa_no
 }
 
 std::string Engine::get_numa_config_as_string() const {
-    return numaContext.get_numa_config().to_string();
+    return host.numaContext.get_numa_config().to_string();
 }
 
 std::string Engine::numa_config_information_as_string() const {
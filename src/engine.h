@@ -19,9 +19,13 @@
 #ifndef ENGINE_H_INCLUDED
 #define ENGINE_H_INCLUDED
 
+#include <atomic>
+#include <condition_variable>
 #include <cstddef>
 #include <cstdint>
 #include <functional>
+#include <memory>
+#include <mutex>
 #include <optional>
 #include <string>
 #include <string_view>
@@ -39,6 +43,45 @@
 
 namespace Stockfish {
 
+// The part of an engine that several engines can share: the networks, replicated
+// once per NUMA node, and a budget of search threads. A standalone engine owns a
+// private host. A game server creates one host and many engines on it, each one
+// with its own options, position, threads and TT, so that an engine costs little
+// more than its TT and threads, and the searches never use more threads than the
+// host allows.
+class EngineHost {
+   public:
+    // maxThreads is the number of threads all the engines can search with at the
+    // same time, 0 for no limit
+    EngineHost(std::optional<std::string> path = std::nullopt, size_t maxThreads = 0);
+
+    EngineHost(const EngineHost&)            = delete;
+    EngineHost(EngineHost&&)                 = delete;
+    EngineHost& operator=(const EngineHost&) = delete;
+    EngineHost& operator=(EngineHost&&)      = delete;
+
+   private:
+    friend class Engine;
+
+    // Waits until count threads of the budget are free and takes them, at most
+    // the whole budget. Returns the number of threads taken, to release them, or
+    // 0 if the stop flag is raised while waiting.
+    size_t acquire_threads(size_t count, const std::atomic_bool* stop = nullptr);
+    void   release_threads(size_t count);
+    // Wakes the searches waiting for threads, to check their stop flag
+    void wake_waiting();
+
+    const std::string binaryDirectory;
+
+    NumaReplicationContext                             numaContext;
+    LazyNumaReplicatedSystemWide<Eval::NNUE::Networks> networks;
+
+    const size_t            maxThreads;
+    size_t                  busyThreads = 0;
+    std::mutex              mutex;
+    std::condition_variable threadsFreed;
+};
+
 class Engine {
    public:
     using InfoShort = Search::InfoShort;
@@ -46,6 +89,10 @@ class Engine {
     using InfoIter  = Search::InfoIteration;
 
     Engine(std::optional<std::string> path = std::nullopt);
+    // An engine sharing the networks and the thread budget of the host, which
+    // must outlive it. The networks and the NUMA configuration of the host
+    // cannot be changed from the engine.
+    explicit Engine(EngineHost& host);
 
     // Cannot be movable due to components holding backreferences to fields
     Engine(const Engine&)            = delete;
@@ -55,13 +102,29 @@ class Engine {
 
     ~Engine() { wait_for_search_finished(); }
 
-    std::uint64_t perft(const std::string& fen, Depth depth, bool isChess960);
+    // Uses threadCount threads of the pool, or all of them with 0, and a perft
+    // table of hashMb MiB unless it is 0
+    std::uint64_t perft(const std::string& fen,
+                        Depth              depth,
+                        bool               isChess960,
+                        size_t             threadCount = 0,
+                        size_t             hashMb      = 0);
 
     // non blocking call to start searching
     void go(Search::LimitsType&);
     // non blocking call to stop searching
     void stop();
 
+    // Blocking call that searches each position alone on one thread of the pool,
+    // calling onResult from that thread as each search finishes
+    void analyze(const std::vector<std::string>&                                   fens,
+                 const Search::LimitsType&                                         limits,
+                 const std::function<void(size_t, const Search::AnalysisResult&)>& onResult);
+
+    // Blocking call that evaluates the positions on all the threads of the pool.
+    // Returns the static evaluations in the order of the positions.
+    std::vector<Value> evaluate(const std::vector<std::string>& fens, Eval::NetSelection net);
+
     // blocking call to wait for search to finish
     void wait_for_search_finished();
     // set a new position, moves are in UCI format
@@ -72,8 +135,11 @@ class Engine {
     void set_numa_config_from_option(const std::string& o);
     void resize_threads();
     void set_tt_size(size_t mb);
+    bool save_tt(const std::string& file);
+    bool load_tt(const std::string& file);
     void set_ponderhit(bool);
-    void search_clear();
+    // A new game, as ucinewgame, keeps the hash entries of a previous run once
+    void search_clear(bool newGame = false);
 
     void set_on_update_no_moves(std::function<void(const InfoShort&)>&&);
     void set_on_update_full(std::function<void(const InfoFull&)>&&);
@@ -88,15 +154,29 @@ class Engine {
     void load_big_network(const std::string& file);
     void load_small_network(const std::string& file);
     void save_network(const std::pair<std::optional<std::string>, std::string> files[2]);
+    // Saves the networks in the runtime layout, the big one first, and returns
+    // whether both were saved. An empty file name skips a network, and no file
+    // name saves the runtime copy of the default net, loaded first at startup.
+    bool save_runtime_networks(const std::optional<std::string>& bigFile,
+                               const std::optional<std::string>& smallFile) const;
 
     // utility functions
 
-    void trace_eval() const;
+    void        trace_eval() const;
+    std::string accumulator_benchmark(Depth depth) const;
+    std::string nnue_benchmark(int rounds) const;
 
     const OptionsMap& get_options() const;
     OptionsMap&       get_options();
 
     int get_hashfull(int maxAge = 0) const;
+    // TT probes of the last search served by the local and by remote NUMA nodes,
+    // only counted when the table is placed on the nodes with HashNumaPlacement
+    std::pair<uint64_t, uint64_t> get_tt_numa_probes() const;
+    // TT statistics of the last search, only collected with HashStats
+    TTStats get_tt_stats() const;
+    // Evaluation cache counters of the last search, summed over the threads
+    EvalCache::Stats get_eval_cache_stats() const;
 
     std::string                            fen() const;
     void                                   flip();
@@ -106,19 +186,30 @@ class Engine {
     std::string                            numa_config_information_as_string() const;
     std::string                            thread_allocation_information_as_string() const;
     std::string                            thread_binding_information_as_string() const;
+    std::string                            tt_stats_as_string() const;
 
    private:
-    const std::string binaryDirectory;
+    Engine(EngineHost* sharedHost, std::optional<std::string> path);
+
+    // Set for a standalone engine, which can change the networks of its host
+    const std::unique_ptr<EngineHost> ownHost;
+    EngineHost&                       host;
 
-    NumaReplicationContext numaContext;
+    // The threads taken from the budget of the host by the running search
+    size_t searchThreads = 0;
 
     Position     pos;
     StateListPtr states;
 
-    OptionsMap                                         options;
-    ThreadPool                                         threads;
-    TranspositionTable                                 tt;
-    LazyNumaReplicatedSystemWide<Eval::NNUE::Networks> networks;
+    // How the position was set, to only play the new moves when a GUI sends the
+    // moves of the whole game again. The moves are the ones actually played.
+    std::string              positionFen;
+    bool                     positionChess960 = false;
+    std::vector<std::string> positionMoves;
+
+    OptionsMap         options;
+    ThreadPool         threads;
+    TranspositionTable tt;
 
     Search::SearchManager::UpdateContext  updateContext;
     std::function<void(std::string_view)> onVerifyNetworks;
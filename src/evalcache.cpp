@@ -0,0 +1,151 @@
+/*
+  Capablanca Enhanced - NNUE Evaluation Cache
+  Copyright (C) 2025 Capablanca Chess Engine Team
+
+  This file implements a fast cache for NNUE evaluations to avoid
+  redundant neural network calculations.
+*/
+
+#include "evalcache.h"
+
+#include <algorithm>
+#include <atomic>
+#include <iomanip>
+#include <memory>
+#include <sstream>
+#include <thread>
+
+#include "misc.h"
+
+namespace Stockfish {
+
+void EvalCache::resize(size_t mbSize) {
+    size_t count = 0;
+
+    if (mbSize)
+    {
+        count = 1;
+        while (count * 2 * sizeof(Entry) <= mbSize * 1024 * 1024)
+            count *= 2;
+    }
+
+    if (count == table.size())
+        return;
+
+    table.assign(count, Entry{});
+    stats = {};
+}
+
+void EvalCache::clear() {
+    std::fill(table.begin(), table.end(), Entry{});
+    stats = {};
+}
+
+
+namespace {
+
+// The evaluation cache as it used to be: one table of final evaluations shared
+// by all the threads, whose entries and counters every thread writes to. Relaxed
+// atomics compile to the same plain loads and stores, without making the races
+// undefined behavior.
+class SharedEvalCache {
+   public:
+    static constexpr int SIZE = 16384;
+    static constexpr int MASK = SIZE - 1;
+
+    bool probe(Key posKey, EvalCache::Output& output) {
+        Entry& e = table[posKey & MASK];
+        if (e.key.load(std::memory_order_relaxed) == posKey)
+        {
+            output.psqt = e.eval.load(std::memory_order_relaxed);
+            increment(hits);
+            return true;
+        }
+        increment(misses);
+        return false;
+    }
+
+    void store(Key posKey, const EvalCache::Output& output) {
+        Entry& e = table[posKey & MASK];
+        e.key.store(posKey, std::memory_order_relaxed);
+        e.eval.store(Value(output.psqt), std::memory_order_relaxed);
+        increment(stores);
+    }
+
+   private:
+    struct Entry {
+        std::atomic<Key>   key{0};
+        std::atomic<Value> eval{VALUE_NONE};
+    };
+
+    static void increment(std::atomic<uint64_t>& c) {
+        c.store(c.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    }
+
+    Entry                 table[SIZE];
+    std::atomic<uint64_t> hits{0}, misses{0}, stores{0};
+};
+
+// Each thread evaluates positions drawn from its own set, with the store
+// following a miss as in Eval::evaluate(). Returns millions of probes per second.
+template<typename MakeCache>
+double run_threads(size_t threadCount, MakeCache makeCache) {
+    constexpr size_t ProbesPerThread = 1 << 24;
+    constexpr size_t PositionsNb     = 1 << 16;
+
+    std::vector<std::thread> workers;
+    TimePoint                start = now();
+
+    for (size_t t = 0; t < threadCount; ++t)
+        workers.emplace_back([t, &makeCache]() {
+            auto              cache = makeCache();
+            PRNG              rng(1070372 + t);
+            EvalCache::Output out;
+
+            for (size_t i = 0; i < ProbesPerThread; ++i)
+            {
+                const Key key = (rng.rand<Key>() % PositionsNb + t * PositionsNb)
+                              * 0x9E3779B97F4A7C15ULL;
+
+                if (!cache->probe(key, out))
+                    cache->store(key, {int(key >> 48) - 32768, int(key >> 32 & 0xFFFF), false});
+            }
+        });
+
+    for (auto& th : workers)
+        th.join();
+
+    const TimePoint elapsed = std::max<TimePoint>(now() - start, 1);
+    return double(threadCount * ProbesPerThread) / elapsed / 1000;
+}
+
+}  // namespace
+
+
+std::string eval_cache_scaling_benchmark(size_t maxThreads, size_t mbSize) {
+    auto shared = std::make_unique<SharedEvalCache>();
+
+    std::stringstream ss;
+    ss << "Evaluation cache throughput [million probes/s]\n"
+       << std::setw(8) << "threads" << std::setw(12) << "shared" << std::setw(12)
+       << "per thread" << '\n'
+       << std::fixed << std::setprecision(1);
+
+    for (size_t threads = 1; threads <= maxThreads; threads *= 2)
+    {
+        const double sharedRate = run_threads(threads, [&shared]() { return shared.get(); });
+
+        const double ownRate = run_threads(threads, [mbSize]() {
+            auto cache = std::make_unique<EvalCache>();
+            cache->resize(mbSize);
+            return cache;
+        });
+
+        ss << std::setw(8) << threads << std::setw(12) << sharedRate << std::setw(12) << ownRate
+           << '\n';
+    }
+
+    return ss.str();
+}
+
+}  // namespace Stockfish
@@ -9,83 +9,112 @@
 #ifndef EVALCACHE_H_INCLUDED
 #define EVALCACHE_H_INCLUDED
 
+#include <cstddef>
 #include <cstdint>
+#include <string>
+#include <vector>
+
 #include "types.h"
 
 namespace Stockfish {
 
-// Fast evaluation cache to avoid redundant NNUE calculations
-// Uses simple direct-mapped cache with position key as index
+// Fast evaluation cache to avoid redundant NNUE calculations.
+// Each search thread owns one, so entries and counters are never shared
+// between threads. It is a direct-mapped table indexed by the low bits of
+// the position key, the upper 32 bits of the key verify a hit.
+// It holds the outputs of the network, before they are blended with the
+// optimism, the material and the rule50 count, so that a hit serves any
+// search whatever its optimism.
 class EvalCache {
    public:
-    // Cache entry stores position key and evaluation
-    struct Entry {
-        Key   key;
-        Value eval;
-
-        Entry() : key(0), eval(VALUE_NONE) {}
+    // The outputs of the network that evaluated a position
+    struct Output {
+        int  psqt;
+        int  positional;
+        bool smallNet;
     };
 
-    static constexpr int SIZE = 16384;  // Must be power of 2
-    static constexpr int MASK = SIZE - 1;
+    // Cache statistics (for tuning/debugging), aggregated over the threads on request
+    struct Stats {
+        uint64_t hits   = 0;
+        uint64_t misses = 0;
+        uint64_t stores = 0;
 
-    EvalCache() { clear(); }
+        double hitRate() const {
+            uint64_t total = hits + misses;
+            return total > 0 ? (100.0 * hits) / total : 0.0;
+        }
+
+        Stats& operator+=(const Stats& other) {
+            hits += other.hits;
+            misses += other.misses;
+            stores += other.stores;
+            return *this;
+        }
+    };
+
+    // Sets the size in MiB, rounded down to a power of 2 number of entries. A size
+    // of 0 disables the cache. The entries are cleared when the size changes.
+    void resize(size_t mbSize);
+    void clear();
 
     // Probe the cache for a position
-    // Returns true if found, and sets 'value' to cached evaluation
-    bool probe(Key posKey, Value& value) const {
+    // Returns true if found, and sets 'output' to the cached network outputs
+    bool probe(Key posKey, Output& output) {
+        if (table.empty())
+            return false;
+
         const Entry& e = table[index(posKey)];
-        if (e.key == posKey) {
-            value = e.eval;
-            hits++;
+        if (e.key32 == uint32_t(posKey >> 32) && e.net != Entry::NoNet)
+        {
+            output = {e.psqt, e.positional, e.net == Entry::SmallNet};
+            stats.hits++;
             return true;
         }
-        misses++;
+        stats.misses++;
         return false;
     }
 
-    // Store evaluation in cache
-    void store(Key posKey, Value value) {
-        Entry& e = table[index(posKey)];
-        e.key = posKey;
-        e.eval = value;
-        stores++;
-    }
+    // Store the network outputs in cache
+    void store(Key posKey, const Output& output) {
+        if (table.empty())
+            return;
 
-    // Clear the entire cache
-    void clear() {
-        for (int i = 0; i < SIZE; ++i) {
-            table[i].key = 0;
-            table[i].eval = VALUE_NONE;
-        }
-        hits = misses = stores = 0;
+        table[index(posKey)] = {uint32_t(posKey >> 32), output.psqt, output.positional,
+                                output.smallNet ? Entry::SmallNet : Entry::BigNet};
+        stats.stores++;
     }
 
-    // Get cache statistics (for tuning/debugging)
-    struct Stats {
-        uint64_t hits;
-        uint64_t misses;
-        uint64_t stores;
-        double hitRate() const {
-            uint64_t total = hits + misses;
-            return total > 0 ? (100.0 * hits) / total : 0.0;
-        }
+    const Stats& get_stats() const { return stats; }
+    void         reset_stats() { stats = {}; }
+
+   private:
+    struct Entry {
+        enum : uint32_t {
+            NoNet,
+            SmallNet,
+            BigNet
+        };
+
+        uint32_t key32;
+        int32_t  psqt;
+        int32_t  positional;
+        uint32_t net;
     };
 
-    Stats get_stats() const {
-        return {hits, misses, stores};
-    }
+    static_assert(sizeof(Entry) == 16, "Entries should not straddle cache lines");
 
-   private:
-    Entry table[SIZE];
-    mutable uint64_t hits = 0;
-    mutable uint64_t misses = 0;
-    mutable uint64_t stores = 0;
+    std::vector<Entry> table;
+    Stats              stats;
 
     // Hash function: extract lower bits of key
-    static int index(Key k) { return static_cast<int>(k & MASK); }
+    size_t index(Key k) const { return size_t(k) & (table.size() - 1); }
 };
 
-} // namespace Stockfish
+// Measures the probe and store throughput with 1, 2, 4, ... up to maxThreads threads,
+// comparing one EvalCache per thread to a single table shared by all threads.
+std::string eval_cache_scaling_benchmark(size_t maxThreads, size_t mbSize);
+
+}  // namespace Stockfish
 
-#endif // #ifndef EVALCACHE_H_INCLUDED
+#endif  // #ifndef EVALCACHE_H_INCLUDED
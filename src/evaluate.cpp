@@ -38,10 +38,6 @@
 
 namespace Stockfish {
 
-// CAPABLANCA ENHANCED: Global NNUE evaluation cache
-// Thread-safe through direct-mapped design (no locking needed)
-static EvalCache globalEvalCache;
-
 // Returns a static, purely materialistic evaluation of the position from
 // the point of view of the side to move. It can be divided by PawnValue to get
 // an approximation of the material advantage on the board in terms of pawns.
@@ -65,31 +61,42 @@ Value Eval::evaluate(const Eval::NNUE::Networks&    networks,
                      const Position&                pos,
                      Eval::NNUE::AccumulatorStack&  accumulators,
                      Eval::NNUE::AccumulatorCaches& caches,
+                     EvalCache&                     evalCache,
                      int                            optimism) {
 
     assert(!pos.checkers());
 
-    // CAPABLANCA ENHANCED: Check evaluation cache first
-    Value cachedEval;
-    Key posKey = pos.key();
-    if (globalEvalCache.probe(posKey, cachedEval) && optimism == 0) {
-        return cachedEval;
-    }
-
-    bool smallNet           = use_smallnet(pos);
-    auto [psqt, positional] = smallNet ? networks.small.evaluate(pos, accumulators, caches.small)
-                                       : networks.big.evaluate(pos, accumulators, caches.big);
-
-    Value nnue = (125 * psqt + 131 * positional) / 128;
+    // CAPABLANCA ENHANCED: Check the evaluation cache of this thread first, it
+    // holds the network outputs so that only the blending below is recomputed.
+    const Key         posKey = pos.key();
+    EvalCache::Output out;
+    Value             nnue;
 
-    // Re-evaluate the position when higher eval accuracy is worth the time spent
-    if (smallNet && (std::abs(nnue) < 236))
+    if (evalCache.probe(posKey, out))
+        nnue = (125 * out.psqt + 131 * out.positional) / 128;
+    else
     {
-        std::tie(psqt, positional) = networks.big.evaluate(pos, accumulators, caches.big);
-        nnue                       = (125 * psqt + 131 * positional) / 128;
-        smallNet                   = false;
+        out.smallNet = use_smallnet(pos);
+        std::tie(out.psqt, out.positional) =
+          out.smallNet ? networks.small.evaluate(pos, accumulators, caches.small)
+                       : networks.big.evaluate(pos, accumulators, caches.big);
+
+        nnue = (125 * out.psqt + 131 * out.positional) / 128;
+
+        // Re-evaluate the position when higher eval accuracy is worth the time spent
+        if (out.smallNet && (std::abs(nnue) < 236))
+        {
+            std::tie(out.psqt, out.positional) =
+              networks.big.evaluate(pos, accumulators, caches.big);
+            nnue         = (125 * out.psqt + 131 * out.positional) / 128;
+            out.smallNet = false;
+        }
+
+        evalCache.store(posKey, out);
     }
 
+    const int psqt = out.psqt, positional = out.positional;
+
     // Blend optimism and eval with nnue complexity
     int nnueComplexity = std::abs(psqt - positional);
     optimism += optimism * nnueComplexity / 468;
@@ -104,11 +111,6 @@ Value Eval::evaluate(const Eval::NNUE::Networks&    networks,
     // Guarantee evaluation does not hit the tablebase range
     v = std::clamp(v, VALUE_TB_LOSS_IN_MAX_PLY + 1, VALUE_TB_WIN_IN_MAX_PLY - 1);
 
-    // CAPABLANCA ENHANCED: Store in evaluation cache (only if optimism == 0)
-    if (optimism == 0) {
-        globalEvalCache.store(posKey, v);
-    }
-
     return v;
 }
 
@@ -121,8 +123,9 @@ std::string Eval::trace(Position& pos, const Eval::NNUE::Networks& networks) {
     if (pos.checkers())
         return "Final evaluation: none (in check)";
 
-    auto accumulators = std::make_unique<Eval::NNUE::AccumulatorStack>();
-    auto caches       = std::make_unique<Eval::NNUE::AccumulatorCaches>(networks);
+    auto      accumulators = std::make_unique<Eval::NNUE::AccumulatorStack>();
+    auto      caches       = std::make_unique<Eval::NNUE::AccumulatorCaches>(networks);
+    EvalCache evalCache;  // Left empty, i.e. disabled
 
     std::stringstream ss;
     ss << std::showpoint << std::noshowpos << std::fixed << std::setprecision(2);
@@ -135,7 +138,7 @@ std::string Eval::trace(Position& pos, const Eval::NNUE::Networks& networks) {
     v                       = pos.side_to_move() == WHITE ? v : -v;
     ss << "NNUE evaluation        " << 0.01 * UCIEngine::to_cp(v, pos) << " (white side)\n";
 
-    v = evaluate(networks, pos, *accumulators, *caches, VALUE_ZERO);
+    v = evaluate(networks, pos, *accumulators, *caches, evalCache, VALUE_ZERO);
     v = pos.side_to_move() == WHITE ? v : -v;
     ss << "Final evaluation       " << 0.01 * UCIEngine::to_cp(v, pos) << " (white side)";
     ss << " [with scaled NNUE, ...]";
@@ -25,6 +25,7 @@
 
 namespace Stockfish {
 
+class EvalCache;
 class Position;
 
 namespace Eval {
@@ -42,6 +43,13 @@ struct AccumulatorCaches;
 class AccumulatorStack;
 }
 
+// The network evaluating a position: the one evaluate() picks, or always the same one
+enum class NetSelection {
+    Auto,
+    Small,
+    Big
+};
+
 std::string trace(Position& pos, const Eval::NNUE::Networks& networks);
 
 int   simple_eval(const Position& pos);
@@ -50,6 +58,7 @@ Value evaluate(const NNUE::Networks&          networks,
                const Position&                pos,
                Eval::NNUE::AccumulatorStack&  accumulators,
                Eval::NNUE::AccumulatorCaches& caches,
+               EvalCache&                     evalCache,
                int                            optimism);
 }  // namespace Eval
 
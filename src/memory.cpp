@@ -24,8 +24,11 @@
     #include <features.h>
 #endif
 
-#if defined(__linux__) && !defined(__ANDROID__)
+#if !defined(_WIN32)
+    #include <fcntl.h>
     #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
 #endif
 
 #if defined(__APPLE__) || defined(__ANDROID__) || defined(__OpenBSD__) \
@@ -196,4 +199,154 @@ void aligned_large_pages_free(void* mem) {
 void aligned_large_pages_free(void* mem) { std_aligned_free(mem); }
 
 #endif
+
+
+// discard_large_pages() drops the pages backing a range of private anonymous
+// memory. The kernel maps fresh zeroed pages, still huge if the range was
+// advised so, only as they get touched again.
+
+#if defined(__linux__) && defined(MADV_DONTNEED)
+
+bool discard_large_pages(void* mem, size_t size) {
+    return mem && madvise(mem, size, MADV_DONTNEED) == 0;
+}
+
+#else
+
+bool discard_large_pages(void*, size_t) { return false; }
+
+#endif
+
+
+// file_mapped_alloc() maps the file at `path` read-write into memory, creating
+// it or adjusting its length to `size` bytes as needed. Writes go to the page
+// cache and therefore survive the process; the kernel flushes them to disk.
+// file_mapped_read() maps an existing file read-only, its pages are shared with
+// every process mapping or reading the same file.
+
+#if defined(_WIN32)
+
+void* file_mapped_alloc(const std::string& path, size_t size) {
+
+    HANDLE hFile = CreateFileA(path.c_str(), GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ, NULL,
+                               OPEN_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (hFile == INVALID_HANDLE_VALUE)
+        return nullptr;
+
+    #if defined(_WIN64)
+    DWORD sizeLow  = size & 0xFFFFFFFFu;
+    DWORD sizeHigh = size >> 32u;
+    #else
+    DWORD sizeLow  = size;
+    DWORD sizeHigh = 0;
+    #endif
+
+    // The mapping object extends the file if needed, and the view keeps
+    // both alive after the handles are closed.
+    HANDLE hMap = CreateFileMappingA(hFile, NULL, PAGE_READWRITE, sizeHigh, sizeLow, NULL);
+    void*  mem  = hMap ? MapViewOfFile(hMap, FILE_MAP_ALL_ACCESS, 0, 0, size) : nullptr;
+
+    if (hMap)
+        CloseHandle(hMap);
+    CloseHandle(hFile);
+
+    return mem;
+}
+
+void file_mapped_free(void* mem, size_t) {
+
+    if (mem)
+        UnmapViewOfFile(mem);
+}
+
+const void* file_mapped_read(const std::string& path, size_t& size) {
+
+    HANDLE hFile = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING,
+                               FILE_ATTRIBUTE_NORMAL, NULL);
+    if (hFile == INVALID_HANDLE_VALUE)
+        return nullptr;
+
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx(hFile, &fileSize) || fileSize.QuadPart == 0)
+    {
+        CloseHandle(hFile);
+        return nullptr;
+    }
+
+    HANDLE hMap = CreateFileMappingA(hFile, NULL, PAGE_READONLY, 0, 0, NULL);
+    void*  mem  = hMap ? MapViewOfFile(hMap, FILE_MAP_READ, 0, 0, 0) : nullptr;
+
+    if (hMap)
+        CloseHandle(hMap);
+    CloseHandle(hFile);
+
+    size = size_t(fileSize.QuadPart);
+    return mem;
+}
+
+#else
+
+void* file_mapped_alloc(const std::string& path, size_t size) {
+
+    int fd = open(path.c_str(), O_RDWR | O_CREAT, 0644);
+    if (fd == -1)
+        return nullptr;
+
+    struct stat st;
+    if (fstat(fd, &st) == -1 || (size_t(st.st_size) != size && ftruncate(fd, off_t(size)) == -1))
+    {
+        close(fd);
+        return nullptr;
+    }
+
+    void* mem = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+
+    if (mem == MAP_FAILED)
+        return nullptr;
+
+    #if defined(MADV_HUGEPAGE)
+    madvise(mem, size, MADV_HUGEPAGE);
+    #endif
+    return mem;
+}
+
+void file_mapped_free(void* mem, size_t size) {
+
+    if (mem)
+        munmap(mem, size);
+}
+
+const void* file_mapped_read(const std::string& path, size_t& size) {
+
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd == -1)
+        return nullptr;
+
+    struct stat st;
+    if (fstat(fd, &st) == -1 || st.st_size == 0)
+    {
+        close(fd);
+        return nullptr;
+    }
+
+    size      = size_t(st.st_size);
+    void* mem = mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+
+    if (mem == MAP_FAILED)
+        return nullptr;
+
+    // Huge pages of the page cache need a kernel that supports them for files
+    #if defined(MADV_HUGEPAGE)
+    madvise(mem, size, MADV_HUGEPAGE);
+    #endif
+    #if defined(MADV_SEQUENTIAL)
+    madvise(mem, size, MADV_SEQUENTIAL);
+    #endif
+    return mem;
+}
+
+#endif
+
 }  // namespace Stockfish
@@ -24,6 +24,7 @@
 #include <cstdint>
 #include <memory>
 #include <new>
+#include <string>
 #include <type_traits>
 #include <utility>
 
@@ -68,8 +69,22 @@ void  std_aligned_free(void* ptr);
 void* aligned_large_pages_alloc(size_t size);
 void  aligned_large_pages_free(void* mem);
 
+// Gives pages of memory from aligned_large_pages_alloc() back to the system, they
+// read as zero when touched again. Returns false on unsupported systems, where the
+// memory is left as is.
+bool discard_large_pages(void* mem, size_t size);
+
 bool has_large_pages();
 
+// Memory backed by a file, shared with every other mapping of the same file.
+// Returns nullptr if the file cannot be mapped, or on unsupported systems.
+void* file_mapped_alloc(const std::string& path, size_t size);
+void  file_mapped_free(void* mem, size_t size);
+
+// Maps an existing file read-only, and sets size to its length. Returns nullptr
+// if the file cannot be mapped. The memory is freed with file_mapped_free().
+const void* file_mapped_read(const std::string& path, size_t& size);
+
 // Frees memory which was placed there with placement new.
 // Works for both single objects and arrays of unknown bound.
 template<typename T, typename FREE_FUNC>
@@ -82,10 +82,15 @@ class Logger {
     std::ofstream file;
     Tie           in, out;
 
+    static Logger& instance() {
+        static Logger l;
+        return l;
+    }
+
    public:
     static void start(const std::string& fname) {
 
-        static Logger l;
+        Logger& l = instance();
 
         if (l.file.is_open())
         {
@@ -108,6 +113,15 @@ class Logger {
             std::cout.rdbuf(&l.out);
         }
     }
+
+    // Writes a line to the log file only, prefixed to tell it from the I/O
+    static void write(std::string_view message) {
+
+        Logger& l = instance();
+
+        if (l.file.is_open())
+            l.file << "## " << message << std::endl;
+    }
 };
 
 }  // namespace
@@ -431,6 +445,8 @@ void sync_cout_end() { std::cout << IO_UNLOCK; }
 // Trampoline helper to avoid moving Logger to misc.h
 void start_logger(const std::string& fname) { Logger::start(fname); }
 
+void write_to_log(std::string_view message) { Logger::write(message); }
+
 
 #ifdef NO_PREFETCH
 
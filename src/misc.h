@@ -51,6 +51,8 @@ std::string compiler_info();
 void prefetch(const void* addr);
 
 void start_logger(const std::string& fname);
+// Writes the message to the debug log file only, if there is one
+void write_to_log(std::string_view message);
 
 size_t str_to_size_t(const std::string& s);
 
@@ -19,6 +19,7 @@
 #include "network.h"
 
 #include <cstdlib>
+#include <cstring>
 #include <fstream>
 #include <iostream>
 #include <optional>
@@ -29,6 +30,7 @@
 #include "../incbin/incbin.h"
 
 #include "../evaluate.h"
+#include "../memory.h"
 #include "../misc.h"
 #include "../position.h"
 #include "../types.h"
@@ -78,6 +80,50 @@ EmbeddedNNUE get_embedded(EmbeddedNNUEType type) {
         return EmbeddedNNUE(gEmbeddedNNUESmallData, gEmbeddedNNUESmallEnd, gEmbeddedNNUESmallSize);
 }
 
+// Header of a network file in the runtime layout. The parameters follow at
+// dataOffset, page aligned, as the bytes of the feature transformer and then of
+// the layer stacks, in the byte order of the engine that saved them.
+struct RuntimeHeader {
+    char          magic[8];
+    std::uint32_t byteOrder;
+    std::uint32_t version;
+    std::uint32_t hash;
+    std::uint32_t layout;
+    std::uint64_t transformerSize;
+    std::uint64_t layersSize;
+    std::uint64_t dataOffset;
+    char          description[256];
+};
+
+constexpr char          RuntimeMagic[8]   = {'C', 'A', 'P', 'A', 'N', 'N', 'R', 'T'};
+constexpr std::uint32_t RuntimeByteOrder  = 0x01020304;
+constexpr std::uint32_t RuntimeVersion    = 1;
+constexpr std::uint64_t RuntimeDataOffset = 4096;
+
+static_assert(sizeof(RuntimeHeader) <= RuntimeDataOffset);
+
+// The layout of the weights in memory depends on the SIMD instructions the
+// engine is built for: the feature transformer permutes them for the packus of
+// AVX2 and AVX-512, and the affine layers scramble them for SSSE3 and NEON.
+constexpr std::uint32_t runtime_layout() {
+    std::uint32_t layout = 0;
+#if defined(USE_AVX512)
+    layout |= 1;
+#elif defined(USE_AVX2)
+    layout |= 2;
+#endif
+#if defined(USE_SSSE3)
+    layout |= 4;
+#endif
+#if defined(USE_NEON_DOTPROD)
+    layout |= 8;
+#endif
+#if defined(USE_NEON)
+    layout |= std::uint32_t(USE_NEON) << 8;
+#endif
+    return layout;
+}
+
 }
 
 
@@ -119,6 +165,20 @@ void Network<Arch, Transformer>::load(const std::string& rootDirectory, std::str
     if (evalfilePath.empty())
         evalfilePath = evalFile.defaultName;
 
+    // The runtime copy of the default net, saved by export_runtime_net without
+    // file names, is looked for first, so that starting skips the decoding
+    if (evalfilePath == std::string(evalFile.defaultName))
+        for (const auto& directory : dirs)
+        {
+            std::string description;
+            if (directory != "<internal>" && std::string(evalFile.current) != evalfilePath
+                && load_runtime(directory + runtime_default_name(), description))
+            {
+                evalFile.current        = evalfilePath;
+                evalFile.netDescription = description;
+            }
+        }
+
     for (const auto& directory : dirs)
     {
         if (std::string(evalFile.current) != evalfilePath)
@@ -168,6 +228,43 @@ bool Network<Arch, Transformer>::save(const std::optional<std::string>& filename
 }
 
 
+template<typename Arch, typename Transformer>
+bool Network<Arch, Transformer>::save_runtime(const std::optional<std::string>& file) const {
+    static_assert(std::is_trivially_copyable_v<Transformer> && std::is_trivially_copyable_v<Arch>);
+
+    // Only the default net can be saved under the runtime name of the default net
+    if (!initialized
+        || (!file && std::string(evalFile.current) != std::string(evalFile.defaultName)))
+        return false;
+
+    const std::string filename = file.value_or(runtime_default_name());
+    if (filename.empty())
+        return false;
+
+    RuntimeHeader header{};
+    std::memcpy(header.magic, RuntimeMagic, sizeof(RuntimeMagic));
+    header.byteOrder       = RuntimeByteOrder;
+    header.version         = RuntimeVersion;
+    header.hash            = Network::hash;
+    header.layout          = runtime_layout();
+    header.transformerSize = sizeof(featureTransformer);
+    header.layersSize      = sizeof(network);
+    header.dataOffset      = RuntimeDataOffset;
+    std::strncpy(header.description, evalFile.netDescription.c_str(),
+                 sizeof(header.description) - 1);
+
+    const std::vector<char> padding(RuntimeDataOffset - sizeof(header), 0);
+
+    std::ofstream stream(filename, std::ios_base::binary);
+    stream.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    stream.write(padding.data(), padding.size());
+    stream.write(reinterpret_cast<const char*>(&featureTransformer), sizeof(featureTransformer));
+    stream.write(reinterpret_cast<const char*>(network), sizeof(network));
+
+    return bool(stream);
+}
+
+
 template<typename Arch, typename Transformer>
 NetworkOutput
 Network<Arch, Transformer>::evaluate(const Position&                         pos,
@@ -189,6 +286,30 @@ Network<Arch, Transformer>::evaluate(const Position&                         pos
 }
 
 
+template<typename Arch, typename Transformer>
+void Network<Arch, Transformer>::update_accumulators(const Position&   pos,
+                                                     AccumulatorStack& accumulatorStack,
+                                                     AccumulatorCaches::Cache<FTDimensions>& cache,
+                                                     bool fuseFeatureSets) const {
+    accumulatorStack.evaluate(pos, featureTransformer, cache, fuseFeatureSets);
+}
+
+template<typename Arch, typename Transformer>
+void Network<Arch, Transformer>::prefetch_weights(const Position&         pos,
+                                                  const AccumulatorStack& accumulatorStack) const {
+    accumulatorStack.prefetch_weights(pos, featureTransformer);
+}
+
+template<typename Arch, typename Transformer>
+std::int32_t Network<Arch, Transformer>::transform(const Position&   pos,
+                                                   AccumulatorStack& accumulatorStack,
+                                                   AccumulatorCaches::Cache<FTDimensions>& cache,
+                                                   TransformedFeatureType*                 output,
+                                                   int bucket) const {
+    return featureTransformer.transform(pos, accumulatorStack, cache, output, bucket);
+}
+
+
 template<typename Arch, typename Transformer>
 void Network<Arch, Transformer>::verify(std::string                                  evalfilePath,
                                         const std::function<void(std::string_view)>& f) const {
@@ -262,6 +383,14 @@ Network<Arch, Transformer>::trace_evaluate(const Position&
 template<typename Arch, typename Transformer>
 void Network<Arch, Transformer>::load_user_net(const std::string& dir,
                                                const std::string& evalfilePath) {
+    std::string runtimeDescription;
+    if (load_runtime(dir + evalfilePath, runtimeDescription))
+    {
+        evalFile.current        = evalfilePath;
+        evalFile.netDescription = runtimeDescription;
+        return;
+    }
+
     std::ifstream stream(dir + evalfilePath, std::ios::binary);
     auto          description = load(stream);
 
@@ -300,6 +429,55 @@ void Network<Arch, Transformer>::load_internal() {
 }
 
 
+// Loads a network file in the runtime layout. The file is mapped, and its
+// parameters are copied as they are, without the decoding and the permutation
+// of the other files: the copy runs at the speed of the page cache. Returns
+// false, leaving the network as it is, if the file is not in the runtime layout
+// of this engine.
+template<typename Arch, typename Transformer>
+bool Network<Arch, Transformer>::load_runtime(const std::string& path, std::string& description) {
+    std::size_t size = 0;
+    const void* mem  = file_mapped_read(path, size);
+    if (!mem)
+        return false;
+
+    const auto* data = static_cast<const char*>(mem);
+
+    RuntimeHeader header{};
+    if (size >= sizeof(header))
+        std::memcpy(&header, data, sizeof(header));
+
+    const bool valid = size >= sizeof(header)
+                    && !std::memcmp(header.magic, RuntimeMagic, sizeof(RuntimeMagic))
+                    && header.byteOrder == RuntimeByteOrder && header.version == RuntimeVersion
+                    && header.hash == Network::hash && header.layout == runtime_layout()
+                    && header.transformerSize == sizeof(featureTransformer)
+                    && header.layersSize == sizeof(network)
+                    && size == header.dataOffset + header.transformerSize + header.layersSize;
+
+    if (valid)
+    {
+        initialize();
+        std::memcpy(&featureTransformer, data + header.dataOffset, sizeof(featureTransformer));
+        std::memcpy(network, data + header.dataOffset + sizeof(featureTransformer),
+                    sizeof(network));
+
+        header.description[sizeof(header.description) - 1] = '\0';
+        description                                         = header.description;
+    }
+
+    file_mapped_free(const_cast<void*>(mem), size);
+    return valid;
+}
+
+
+// The runtime copy of the default net is named after it
+template<typename Arch, typename Transformer>
+std::string Network<Arch, Transformer>::runtime_default_name() const {
+    return std::string(evalFile.defaultName) + ".rt";
+}
+
+
 template<typename Arch, typename Transformer>
 void Network<Arch, Transformer>::initialize() {
     initialized = true;
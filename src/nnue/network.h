@@ -72,12 +72,34 @@ class Network {
     void load(const std::string& rootDirectory, std::string evalfilePath);
     bool save(const std::optional<std::string>& filename) const;
 
+    // Saves the network in the runtime layout, the weights as they are in memory,
+    // which load() maps and copies without decoding them. The file only fits
+    // engines built for the same SIMD architecture. Without a filename, the
+    // default net is saved as the runtime copy that load() looks for first.
+    bool save_runtime(const std::optional<std::string>& filename) const;
+
     std::size_t get_content_hash() const;
 
     NetworkOutput evaluate(const Position&                         pos,
                            AccumulatorStack&                       accumulatorStack,
                            AccumulatorCaches::Cache<FTDimensions>& cache) const;
 
+    // Only updates the accumulators of the position, to benchmark the updates
+    void update_accumulators(const Position&                         pos,
+                             AccumulatorStack&                       accumulatorStack,
+                             AccumulatorCaches::Cache<FTDimensions>& cache,
+                             bool                                    fuseFeatureSets) const;
+
+    void prefetch_weights(const Position& pos, const AccumulatorStack& accumulatorStack) const;
+
+    // The stages of evaluate(), run one at a time by the NNUE benchmark
+    std::int32_t transform(const Position&                         pos,
+                           AccumulatorStack&                       accumulatorStack,
+                           AccumulatorCaches::Cache<FTDimensions>& cache,
+                           TransformedFeatureType*                 output,
+                           int                                     bucket) const;
+    const Arch&  layer_stack(int bucket) const { return network[bucket]; }
+
 
     void verify(std::string evalfilePath, const std::function<void(std::string_view)>&) const;
     NnueEvalTrace trace_evaluate(const Position&                         pos,
@@ -87,6 +109,8 @@ class Network {
    private:
     void load_user_net(const std::string&, const std::string&);
     void load_internal();
+    bool        load_runtime(const std::string&, std::string&);
+    std::string runtime_default_name() const;
 
     void initialize();
 
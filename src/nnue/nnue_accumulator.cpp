@@ -65,6 +65,26 @@ void update_accumulator_incremental(
   AccumulatorState<FeatureSet>&                           target_state,
   const AccumulatorState<FeatureSet>&                     computed);
 
+template<Color Perspective, typename FeatureSet, IndexType TransformedFeatureDimensions>
+bool update_accumulator_multi_ply(
+  const FeatureTransformer<TransformedFeatureDimensions>& featureTransformer,
+  const Square                                            ksq,
+  AccumulatorState<FeatureSet>*                           states,
+  const std::size_t                                       plies);
+
+template<Color Perspective, IndexType Dimensions>
+void update_feature_sets_incremental(const FeatureTransformer<Dimensions>&     featureTransformer,
+                                     const Square                              ksq,
+                                     AccumulatorState<PSQFeatureSet>&          psqTarget,
+                                     const AccumulatorState<PSQFeatureSet>&    psqComputed,
+                                     AccumulatorState<ThreatFeatureSet>&       threatTarget,
+                                     const AccumulatorState<ThreatFeatureSet>& threatComputed);
+
+template<Color Perspective, typename FeatureSet, IndexType Dimensions>
+void prefetch_changed_rows(const FeatureTransformer<Dimensions>&   featureTransformer,
+                           const Square                            ksq,
+                           const typename FeatureSet::DiffType& diff);
+
 template<Color Perspective, IndexType Dimensions>
 void update_accumulator_refresh_cache(const FeatureTransformer<Dimensions>& featureTransformer,
                                       const Position&                       pos,
@@ -137,21 +157,85 @@ void AccumulatorStack::pop() noexcept {
     size--;
 }
 
+template<IndexType Dimensions>
+void AccumulatorStack::prefetch_weights(
+  const Position& pos, const FeatureTransformer<Dimensions>& featureTransformer) const noexcept {
+    const Square wksq = pos.square<KING>(WHITE);
+    const Square bksq = pos.square<KING>(BLACK);
+
+    const auto& psqDiff = latest<PSQFeatureSet>().diff;
+    prefetch_changed_rows<WHITE, PSQFeatureSet>(featureTransformer, wksq, psqDiff);
+    prefetch_changed_rows<BLACK, PSQFeatureSet>(featureTransformer, bksq, psqDiff);
+
+    if constexpr (Dimensions == TransformedFeatureDimensionsBig)
+    {
+        const auto& threatDiff = latest<ThreatFeatureSet>().diff;
+        prefetch_changed_rows<WHITE, ThreatFeatureSet>(featureTransformer, wksq, threatDiff);
+        prefetch_changed_rows<BLACK, ThreatFeatureSet>(featureTransformer, bksq, threatDiff);
+    }
+}
+
+template void AccumulatorStack::prefetch_weights<TransformedFeatureDimensionsBig>(
+  const Position&, const FeatureTransformer<TransformedFeatureDimensionsBig>&) const noexcept;
+template void AccumulatorStack::prefetch_weights<TransformedFeatureDimensionsSmall>(
+  const Position&, const FeatureTransformer<TransformedFeatureDimensionsSmall>&) const noexcept;
+
 template<IndexType Dimensions>
 void AccumulatorStack::evaluate(const Position&                       pos,
                                 const FeatureTransformer<Dimensions>& featureTransformer,
-                                AccumulatorCaches::Cache<Dimensions>& cache) noexcept {
+                                AccumulatorCaches::Cache<Dimensions>& cache,
+                                bool                                  fuseFeatureSets) noexcept {
     constexpr bool UseThreats = (Dimensions == TransformedFeatureDimensionsBig);
 
-    evaluate_side<WHITE, PSQFeatureSet>(pos, featureTransformer, cache);
+    if (!fuseFeatureSets || !fused_update_incremental<WHITE>(pos, featureTransformer))
+    {
+        evaluate_side<WHITE, PSQFeatureSet>(pos, featureTransformer, cache);
+
+        if (UseThreats)
+            evaluate_side<WHITE, ThreatFeatureSet>(pos, featureTransformer, cache);
+    }
+
+    if (!fuseFeatureSets || !fused_update_incremental<BLACK>(pos, featureTransformer))
+    {
+        evaluate_side<BLACK, PSQFeatureSet>(pos, featureTransformer, cache);
 
-    if (UseThreats)
-        evaluate_side<WHITE, ThreatFeatureSet>(pos, featureTransformer, cache);
+        if (UseThreats)
+            evaluate_side<BLACK, ThreatFeatureSet>(pos, featureTransformer, cache);
+    }
+}
 
-    evaluate_side<BLACK, PSQFeatureSet>(pos, featureTransformer, cache);
+// Updates the piece-square and threat accumulators of the big net in one pass
+// over the tiles, when both are one move behind and the move needs no refresh,
+// which is the most common case. Returns false otherwise.
+template<Color Perspective, IndexType Dimensions>
+bool AccumulatorStack::fused_update_incremental(
+  const Position& pos, const FeatureTransformer<Dimensions>& featureTransformer) noexcept {
 
-    if (UseThreats)
-        evaluate_side<BLACK, ThreatFeatureSet>(pos, featureTransformer, cache);
+    if constexpr (Dimensions != TransformedFeatureDimensionsBig)
+        return false;
+    else
+    {
+        if (size < 2)
+            return false;
+
+        auto&       psqTarget      = psq_accumulators[size - 1];
+        const auto& psqComputed    = psq_accumulators[size - 2];
+        auto&       threatTarget   = threat_accumulators[size - 1];
+        const auto& threatComputed = threat_accumulators[size - 2];
+
+        if (!psqComputed.acc<Dimensions>().computed[Perspective]
+            || !threatComputed.acc<Dimensions>().computed[Perspective]
+            || psqTarget.acc<Dimensions>().computed[Perspective]
+            || threatTarget.acc<Dimensions>().computed[Perspective]
+            || PSQFeatureSet::requires_refresh(psqTarget.diff, Perspective)
+            || ThreatFeatureSet::requires_refresh(threatTarget.diff, Perspective))
+            return false;
+
+        update_feature_sets_incremental<Perspective>(featureTransformer,
+                                                     pos.square<KING>(Perspective), psqTarget,
+                                                     psqComputed, threatTarget, threatComputed);
+        return true;
+    }
 }
 
 template<Color Perspective, typename FeatureSet, IndexType Dimensions>
@@ -209,7 +293,38 @@ void AccumulatorStack::forward_update_incremental(
 
     const Square ksq = pos.square<KING>(Perspective);
 
-    for (std::size_t next = begin + 1; next < size; next++)
+    std::size_t first = begin + 1;
+
+    // Catch up several plies in one pass over the accumulation. The search reuses
+    // the accumulator of the parent position after taking back the last move, so
+    // the piece-square update stops there and the last ply is done alone. The
+    // threat updates leave the captures of a piece that just moved to
+    // double_inc_update(), which drops the threats of that piece its own way.
+    if constexpr (std::is_same_v<FeatureSet, PSQFeatureSet>)
+    {
+        if (size - begin >= 4
+            && update_accumulator_multi_ply<Perspective>(
+              featureTransformer, ksq, &mut_accumulators<FeatureSet>()[begin], size - 2 - begin))
+            first = size - 1;
+    }
+    else if (size - begin >= 3)
+    {
+        bool doubleCapture = false;
+
+        for (std::size_t next = begin + 1; next + 1 < size && !doubleCapture; next++)
+        {
+            const Square removeSq = psq_accumulators[next + 1].diff.remove_sq;
+            doubleCapture         = removeSq != SQ_NONE
+                         && (threat_accumulators[next].diff.threateningSqs & square_bb(removeSq));
+        }
+
+        if (!doubleCapture
+            && update_accumulator_multi_ply<Perspective>(
+              featureTransformer, ksq, &mut_accumulators<FeatureSet>()[begin], size - 1 - begin))
+            first = size;
+    }
+
+    for (std::size_t next = first; next < size; next++)
     {
         if (next + 1 < size)
         {
@@ -278,11 +393,13 @@ void AccumulatorStack::backward_update_incremental(
 template void AccumulatorStack::evaluate<TransformedFeatureDimensionsBig>(
   const Position&                                            pos,
   const FeatureTransformer<TransformedFeatureDimensionsBig>& featureTransformer,
-  AccumulatorCaches::Cache<TransformedFeatureDimensionsBig>& cache) noexcept;
+  AccumulatorCaches::Cache<TransformedFeatureDimensionsBig>& cache,
+  bool                                                       fuseFeatureSets) noexcept;
 template void AccumulatorStack::evaluate<TransformedFeatureDimensionsSmall>(
   const Position&                                              pos,
   const FeatureTransformer<TransformedFeatureDimensionsSmall>& featureTransformer,
-  AccumulatorCaches::Cache<TransformedFeatureDimensionsSmall>& cache) noexcept;
+  AccumulatorCaches::Cache<TransformedFeatureDimensionsSmall>& cache,
+  bool                                                         fuseFeatureSets) noexcept;
 
 
 namespace {
@@ -339,13 +456,35 @@ struct AccumulatorUpdateContext {
           to_psqt_weight_vector(indices)...);
     }
 
-    void apply(const typename FeatureSet::IndexList& added,
-               const typename FeatureSet::IndexList& removed) {
-        const auto fromAcc = from.template acc<Dimensions>().accumulation[Perspective];
-        const auto toAcc   = to.template acc<Dimensions>().accumulation[Perspective];
+    template<typename IndexList>
+    void apply(const IndexList& added, const IndexList& removed) {
+        AccumulatorState<FeatureSet>* target = &to;
+        apply_plies(&added, &removed, &target, 1);
+    }
 
+    // Applies the changes of consecutive plies in one pass over the accumulation,
+    // each pair of lists giving the changes of a ply and each target the state
+    // after it. The lists can be of any length, with the int8 weights of the
+    // threat features or the int16 weights of the piece-square ones.
+    template<typename IndexList>
+    void apply_plies(const IndexList*                     added,
+                     const IndexList*                     removed,
+                     AccumulatorState<FeatureSet>* const* targets,
+                     const std::size_t                    plies) {
+        constexpr bool Threats = std::is_same_v<FeatureSet, ThreatFeatureSet>;
+
+        const auto fromAcc     = from.template acc<Dimensions>().accumulation[Perspective];
         const auto fromPsqtAcc = from.template acc<Dimensions>().psqtAccumulation[Perspective];
-        const auto toPsqtAcc   = to.template acc<Dimensions>().psqtAccumulation[Perspective];
+
+        auto toAcc = [&](std::size_t p) {
+            return targets[p]->template acc<Dimensions>().accumulation[Perspective];
+        };
+        auto toPsqtAcc = [&](std::size_t p) {
+            return targets[p]->template acc<Dimensions>().psqtAccumulation[Perspective];
+        };
+
+        const PSQTWeightType* psqtWeights = Threats ? featureTransformer.threatPsqtWeights.data()
+                                                    : featureTransformer.psqtWeights.data();
 
 #ifdef VECTOR
         using Tiling = SIMDTiling<Dimensions, Dimensions, PSQTBuckets>;
@@ -355,114 +494,149 @@ struct AccumulatorUpdateContext {
         for (IndexType j = 0; j < Dimensions / Tiling::TileHeight; ++j)
         {
             auto* fromTile = reinterpret_cast<const vec_t*>(&fromAcc[j * Tiling::TileHeight]);
-            auto* toTile   = reinterpret_cast<vec_t*>(&toAcc[j * Tiling::TileHeight]);
 
             for (IndexType k = 0; k < Tiling::NumRegs; ++k)
                 acc[k] = fromTile[k];
 
-            for (IndexType i = 0; i < removed.size(); ++i)
+            for (std::size_t p = 0; p < plies; ++p)
             {
-                IndexType       index  = removed[i];
-                const IndexType offset = Dimensions * index + j * Tiling::TileHeight;
-                auto*           column =
-                  reinterpret_cast<const vec_i8_t*>(&featureTransformer.threatWeights[offset]);
+                for (IndexType i = 0; i < removed[p].size(); ++i)
+                {
+                    IndexType       index  = removed[p][i];
+                    const IndexType offset = Dimensions * index + j * Tiling::TileHeight;
+
+                    if constexpr (!Threats)
+                    {
+                        auto* column =
+                          reinterpret_cast<const vec_t*>(&featureTransformer.weights[offset]);
+
+                        for (IndexType k = 0; k < Tiling::NumRegs; ++k)
+                            acc[k] = vec_sub_16(acc[k], column[k]);
+                    }
+                    else
+                    {
+                        auto* column = reinterpret_cast<const vec_i8_t*>(
+                          &featureTransformer.threatWeights[offset]);
 
     #ifdef USE_NEON
-                for (IndexType k = 0; k < Tiling::NumRegs; k += 2)
-                {
-                    acc[k]     = vec_sub_16(acc[k], vmovl_s8(vget_low_s8(column[k / 2])));
-                    acc[k + 1] = vec_sub_16(acc[k + 1], vmovl_high_s8(column[k / 2]));
-                }
+                        for (IndexType k = 0; k < Tiling::NumRegs; k += 2)
+                        {
+                            acc[k]     = vec_sub_16(acc[k], vmovl_s8(vget_low_s8(column[k / 2])));
+                            acc[k + 1] = vec_sub_16(acc[k + 1], vmovl_high_s8(column[k / 2]));
+                        }
     #else
-                for (IndexType k = 0; k < Tiling::NumRegs; ++k)
-                    acc[k] = vec_sub_16(acc[k], vec_convert_8_16(column[k]));
+                        for (IndexType k = 0; k < Tiling::NumRegs; ++k)
+                            acc[k] = vec_sub_16(acc[k], vec_convert_8_16(column[k]));
     #endif
-            }
+                    }
+                }
 
-            for (IndexType i = 0; i < added.size(); ++i)
-            {
-                IndexType       index  = added[i];
-                const IndexType offset = Dimensions * index + j * Tiling::TileHeight;
-                auto*           column =
-                  reinterpret_cast<const vec_i8_t*>(&featureTransformer.threatWeights[offset]);
+                for (IndexType i = 0; i < added[p].size(); ++i)
+                {
+                    IndexType       index  = added[p][i];
+                    const IndexType offset = Dimensions * index + j * Tiling::TileHeight;
+
+                    if constexpr (!Threats)
+                    {
+                        auto* column =
+                          reinterpret_cast<const vec_t*>(&featureTransformer.weights[offset]);
+
+                        for (IndexType k = 0; k < Tiling::NumRegs; ++k)
+                            acc[k] = vec_add_16(acc[k], column[k]);
+                    }
+                    else
+                    {
+                        auto* column = reinterpret_cast<const vec_i8_t*>(
+                          &featureTransformer.threatWeights[offset]);
 
     #ifdef USE_NEON
-                for (IndexType k = 0; k < Tiling::NumRegs; k += 2)
-                {
-                    acc[k]     = vec_add_16(acc[k], vmovl_s8(vget_low_s8(column[k / 2])));
-                    acc[k + 1] = vec_add_16(acc[k + 1], vmovl_high_s8(column[k / 2]));
-                }
+                        for (IndexType k = 0; k < Tiling::NumRegs; k += 2)
+                        {
+                            acc[k]     = vec_add_16(acc[k], vmovl_s8(vget_low_s8(column[k / 2])));
+                            acc[k + 1] = vec_add_16(acc[k + 1], vmovl_high_s8(column[k / 2]));
+                        }
     #else
-                for (IndexType k = 0; k < Tiling::NumRegs; ++k)
-                    acc[k] = vec_add_16(acc[k], vec_convert_8_16(column[k]));
+                        for (IndexType k = 0; k < Tiling::NumRegs; ++k)
+                            acc[k] = vec_add_16(acc[k], vec_convert_8_16(column[k]));
     #endif
-            }
+                    }
+                }
 
-            for (IndexType k = 0; k < Tiling::NumRegs; k++)
-                vec_store(&toTile[k], acc[k]);
+                auto* toTile = reinterpret_cast<vec_t*>(&toAcc(p)[j * Tiling::TileHeight]);
+
+                for (IndexType k = 0; k < Tiling::NumRegs; k++)
+                    vec_store(&toTile[k], acc[k]);
+            }
         }
 
         for (IndexType j = 0; j < PSQTBuckets / Tiling::PsqtTileHeight; ++j)
         {
             auto* fromTilePsqt =
               reinterpret_cast<const psqt_vec_t*>(&fromPsqtAcc[j * Tiling::PsqtTileHeight]);
-            auto* toTilePsqt =
-              reinterpret_cast<psqt_vec_t*>(&toPsqtAcc[j * Tiling::PsqtTileHeight]);
 
             for (IndexType k = 0; k < Tiling::NumPsqtRegs; ++k)
                 psqt[k] = fromTilePsqt[k];
 
-            for (IndexType i = 0; i < removed.size(); ++i)
+            for (std::size_t p = 0; p < plies; ++p)
             {
-                IndexType       index      = removed[i];
-                const IndexType offset     = PSQTBuckets * index + j * Tiling::PsqtTileHeight;
-                auto*           columnPsqt = reinterpret_cast<const psqt_vec_t*>(
-                  &featureTransformer.threatPsqtWeights[offset]);
+                for (IndexType i = 0; i < removed[p].size(); ++i)
+                {
+                    IndexType       index  = removed[p][i];
+                    const IndexType offset = PSQTBuckets * index + j * Tiling::PsqtTileHeight;
+                    auto* columnPsqt = reinterpret_cast<const psqt_vec_t*>(&psqtWeights[offset]);
 
-                for (std::size_t k = 0; k < Tiling::NumPsqtRegs; ++k)
-                    psqt[k] = vec_sub_psqt_32(psqt[k], columnPsqt[k]);
-            }
+                    for (std::size_t k = 0; k < Tiling::NumPsqtRegs; ++k)
+                        psqt[k] = vec_sub_psqt_32(psqt[k], columnPsqt[k]);
+                }
 
-            for (IndexType i = 0; i < added.size(); ++i)
-            {
-                IndexType       index      = added[i];
-                const IndexType offset     = PSQTBuckets * index + j * Tiling::PsqtTileHeight;
-                auto*           columnPsqt = reinterpret_cast<const psqt_vec_t*>(
-                  &featureTransformer.threatPsqtWeights[offset]);
+                for (IndexType i = 0; i < added[p].size(); ++i)
+                {
+                    IndexType       index  = added[p][i];
+                    const IndexType offset = PSQTBuckets * index + j * Tiling::PsqtTileHeight;
+                    auto* columnPsqt = reinterpret_cast<const psqt_vec_t*>(&psqtWeights[offset]);
 
-                for (std::size_t k = 0; k < Tiling::NumPsqtRegs; ++k)
-                    psqt[k] = vec_add_psqt_32(psqt[k], columnPsqt[k]);
-            }
+                    for (std::size_t k = 0; k < Tiling::NumPsqtRegs; ++k)
+                        psqt[k] = vec_add_psqt_32(psqt[k], columnPsqt[k]);
+                }
 
-            for (IndexType k = 0; k < Tiling::NumPsqtRegs; ++k)
-                vec_store_psqt(&toTilePsqt[k], psqt[k]);
+                auto* toTilePsqt =
+                  reinterpret_cast<psqt_vec_t*>(&toPsqtAcc(p)[j * Tiling::PsqtTileHeight]);
+
+                for (IndexType k = 0; k < Tiling::NumPsqtRegs; ++k)
+                    vec_store_psqt(&toTilePsqt[k], psqt[k]);
+            }
         }
 
 #else
 
-        std::copy_n(fromAcc, Dimensions, toAcc);
-        std::copy_n(fromPsqtAcc, PSQTBuckets, toPsqtAcc);
-
-        for (const auto index : removed)
+        for (std::size_t p = 0; p < plies; ++p)
         {
-            const IndexType offset = Dimensions * index;
+            std::copy_n(p ? toAcc(p - 1) : fromAcc, Dimensions, toAcc(p));
+            std::copy_n(p ? toPsqtAcc(p - 1) : fromPsqtAcc, PSQTBuckets, toPsqtAcc(p));
 
-            for (IndexType j = 0; j < Dimensions; ++j)
-                toAcc[j] -= featureTransformer.threatWeights[offset + j];
+            for (const auto index : removed[p])
+            {
+                const IndexType offset = Dimensions * index;
 
-            for (std::size_t k = 0; k < PSQTBuckets; ++k)
-                toPsqtAcc[k] -= featureTransformer.threatPsqtWeights[index * PSQTBuckets + k];
-        }
+                for (IndexType j = 0; j < Dimensions; ++j)
+                    toAcc(p)[j] -= Threats ? featureTransformer.threatWeights[offset + j]
+                                           : featureTransformer.weights[offset + j];
 
-        for (const auto index : added)
-        {
-            const IndexType offset = Dimensions * index;
+                for (std::size_t k = 0; k < PSQTBuckets; ++k)
+                    toPsqtAcc(p)[k] -= psqtWeights[index * PSQTBuckets + k];
+            }
+
+            for (const auto index : added[p])
+            {
+                const IndexType offset = Dimensions * index;
 
-            for (IndexType j = 0; j < Dimensions; ++j)
-                toAcc[j] += featureTransformer.threatWeights[offset + j];
+                for (IndexType j = 0; j < Dimensions; ++j)
+                    toAcc(p)[j] += Threats ? featureTransformer.threatWeights[offset + j]
+                                           : featureTransformer.weights[offset + j];
 
-            for (std::size_t k = 0; k < PSQTBuckets; ++k)
-                toPsqtAcc[k] += featureTransformer.threatPsqtWeights[index * PSQTBuckets + k];
+                for (std::size_t k = 0; k < PSQTBuckets; ++k)
+                    toPsqtAcc(p)[k] += psqtWeights[index * PSQTBuckets + k];
+            }
         }
 
 #endif
@@ -636,6 +810,299 @@ void update_accumulator_incremental(
     (target_state.template acc<TransformedFeatureDimensions>()).computed[Perspective] = true;
 }
 
+// Updates the accumulators of the plies after the computed states[0], up to
+// states[plies], in one pass over the accumulation. Only states[plies] is written
+// for the piece-square features, and a feature that a ply adds and another one
+// removes is not applied at all. The incremental threat updates do not always give
+// the accumulation of a refresh, so the evaluations depend on which accumulators
+// were computed: all the threat ones are written, as one ply at a time would.
+// Returns false, without updating, when the changes do not fit the lists.
+template<Color Perspective, typename FeatureSet, IndexType TransformedFeatureDimensions>
+bool update_accumulator_multi_ply(
+  const FeatureTransformer<TransformedFeatureDimensions>& featureTransformer,
+  const Square                                            ksq,
+  AccumulatorState<FeatureSet>*                           states,
+  const std::size_t                                       plies) {
+
+    assert((states[0].template acc<TransformedFeatureDimensions>()).computed[Perspective]);
+
+    if constexpr (std::is_same_v<FeatureSet, ThreatFeatureSet>)
+    {
+        constexpr std::size_t MaxPlies = 8;
+
+        typename FeatureSet::IndexList removed[MaxPlies], added[MaxPlies];
+        AccumulatorState<FeatureSet>*  targets[MaxPlies];
+
+        for (std::size_t first = 0; first < plies; first += MaxPlies)
+        {
+            const std::size_t count = std::min(plies - first, MaxPlies);
+
+            for (std::size_t p = 0; p < count; ++p)
+            {
+                removed[p] = added[p] = {};
+                targets[p]            = &states[first + p + 1];
+                FeatureSet::template append_changed_indices<Perspective>(ksq, targets[p]->diff,
+                                                                         removed[p], added[p]);
+            }
+
+            make_accumulator_update_context<Perspective>(featureTransformer, states[first],
+                                                         *targets[0])
+              .apply_plies(added, removed, targets, count);
+
+            for (std::size_t p = 0; p < count; ++p)
+                (targets[p]->template acc<TransformedFeatureDimensions>()).computed[Perspective] =
+                  true;
+        }
+
+        return true;
+    }
+    else
+    {
+        constexpr std::size_t MaxIndices = 4 * FeatureSet::MaxActiveDimensions;
+        using MultiPlyIndexList          = ValueList<IndexType, MaxIndices>;
+
+        MultiPlyIndexList removed, added;
+
+        for (std::size_t i = 1; i <= plies; ++i)
+        {
+            typename FeatureSet::IndexList plyRemoved, plyAdded;
+            FeatureSet::template append_changed_indices<Perspective>(ksq, states[i].diff,
+                                                                     plyRemoved, plyAdded);
+
+            if (removed.size() + plyRemoved.size() > MaxIndices
+                || added.size() + plyAdded.size() > MaxIndices)
+                return false;
+
+            for (const auto index : plyRemoved)
+                removed.push_back(index);
+            for (const auto index : plyAdded)
+                added.push_back(index);
+        }
+
+        // The sums of the weights wrap around the same way in any order, so
+        // cancelling out the pairs gives the same accumulation
+        MultiPlyIndexList netRemoved, netAdded;
+        bool              cancelled[MaxIndices] = {};
+
+        for (const auto index : removed)
+        {
+            std::size_t i = 0;
+            while (i < added.size() && (cancelled[i] || added[i] != index))
+                ++i;
+
+            if (i < added.size())
+                cancelled[i] = true;
+            else
+                netRemoved.push_back(index);
+        }
+
+        for (std::size_t i = 0; i < added.size(); ++i)
+            if (!cancelled[i])
+                netAdded.push_back(added[i]);
+
+        auto& target = states[plies];
+
+        make_accumulator_update_context<Perspective>(featureTransformer, states[0], target)
+          .apply(netAdded, netRemoved);
+
+        (target.template acc<TransformedFeatureDimensions>()).computed[Perspective] = true;
+        return true;
+    }
+}
+
+// Prefetches the weight and PSQT rows of the features changed by a move, unless
+// the accumulator of this perspective is to be refreshed
+template<Color Perspective, typename FeatureSet, IndexType Dimensions>
+void prefetch_changed_rows(const FeatureTransformer<Dimensions>& featureTransformer,
+                           const Square                          ksq,
+                           const typename FeatureSet::DiffType&  diff) {
+    if (FeatureSet::requires_refresh(diff, Perspective))
+        return;
+
+    constexpr bool Threats = std::is_same_v<FeatureSet, ThreatFeatureSet>;
+
+    typename FeatureSet::IndexList removed, added;
+    FeatureSet::template append_changed_indices<Perspective>(ksq, diff, removed, added);
+
+    auto prefetch_rows = [&](const auto& indices) {
+        for (const auto index : indices)
+        {
+            const char* row;
+            std::size_t rowSize;
+
+            if constexpr (Threats)
+            {
+                row = reinterpret_cast<const char*>(
+                  &featureTransformer.threatWeights[Dimensions * index]);
+                rowSize = Dimensions * sizeof(featureTransformer.threatWeights[0]);
+                prefetch(&featureTransformer.threatPsqtWeights[PSQTBuckets * index]);
+            }
+            else
+            {
+                row =
+                  reinterpret_cast<const char*>(&featureTransformer.weights[Dimensions * index]);
+                rowSize = Dimensions * sizeof(featureTransformer.weights[0]);
+                prefetch(&featureTransformer.psqtWeights[PSQTBuckets * index]);
+            }
+
+            for (std::size_t offset = 0; offset < rowSize; offset += CacheLineSize)
+                prefetch(row + offset);
+        }
+    };
+
+    prefetch_rows(removed);
+    prefetch_rows(added);
+}
+
+// Applies the changes of one move to both feature sets, tile by tile: the int16
+// piece-square rows to one register tile, then the int8 threat rows to the same
+// registers, each tile being stored to its own accumulator. The storage stays
+// separate, as the refreshes of the piece-square accumulator go through the
+// cache while the threat one is rebuilt from the position.
+template<Color Perspective, IndexType Dimensions>
+void update_feature_sets_incremental(const FeatureTransformer<Dimensions>&     featureTransformer,
+                                     const Square                              ksq,
+                                     AccumulatorState<PSQFeatureSet>&          psqTarget,
+                                     const AccumulatorState<PSQFeatureSet>&    psqComputed,
+                                     AccumulatorState<ThreatFeatureSet>&       threatTarget,
+                                     const AccumulatorState<ThreatFeatureSet>& threatComputed) {
+
+#ifdef VECTOR
+    using Tiling = SIMDTiling<Dimensions, Dimensions, PSQTBuckets>;
+    vec_t      acc[Tiling::NumRegs];
+    psqt_vec_t psqt[Tiling::NumPsqtRegs];
+
+    PSQFeatureSet::IndexList    psqRemoved, psqAdded;
+    ThreatFeatureSet::IndexList threatRemoved, threatAdded;
+    PSQFeatureSet::append_changed_indices<Perspective>(ksq, psqTarget.diff, psqRemoved, psqAdded);
+    ThreatFeatureSet::append_changed_indices<Perspective>(ksq, threatTarget.diff, threatRemoved,
+                                                          threatAdded);
+
+    auto& psqTo    = psqTarget.acc<Dimensions>();
+    auto& threatTo = threatTarget.acc<Dimensions>();
+
+    for (IndexType j = 0; j < Dimensions / Tiling::TileHeight; ++j)
+    {
+        const IndexType tile = j * Tiling::TileHeight;
+
+        auto* psqFromTile = reinterpret_cast<const vec_t*>(
+          &psqComputed.acc<Dimensions>().accumulation[Perspective][tile]);
+
+        for (IndexType k = 0; k < Tiling::NumRegs; ++k)
+            acc[k] = psqFromTile[k];
+
+        for (const auto index : psqRemoved)
+        {
+            auto* column = reinterpret_cast<const vec_t*>(
+              &featureTransformer.weights[Dimensions * index + tile]);
+            for (IndexType k = 0; k < Tiling::NumRegs; ++k)
+                acc[k] = vec_sub_16(acc[k], column[k]);
+        }
+        for (const auto index : psqAdded)
+        {
+            auto* column = reinterpret_cast<const vec_t*>(
+              &featureTransformer.weights[Dimensions * index + tile]);
+            for (IndexType k = 0; k < Tiling::NumRegs; ++k)
+                acc[k] = vec_add_16(acc[k], column[k]);
+        }
+
+        auto* psqToTile = reinterpret_cast<vec_t*>(&psqTo.accumulation[Perspective][tile]);
+        for (IndexType k = 0; k < Tiling::NumRegs; ++k)
+            vec_store(&psqToTile[k], acc[k]);
+
+        auto* threatFromTile = reinterpret_cast<const vec_t*>(
+          &threatComputed.acc<Dimensions>().accumulation[Perspective][tile]);
+
+        for (IndexType k = 0; k < Tiling::NumRegs; ++k)
+            acc[k] = threatFromTile[k];
+
+        for (const auto index : threatRemoved)
+        {
+            auto* column = reinterpret_cast<const vec_i8_t*>(
+              &featureTransformer.threatWeights[Dimensions * index + tile]);
+    #ifdef USE_NEON
+            for (IndexType k = 0; k < Tiling::NumRegs; k += 2)
+            {
+                acc[k]     = vec_sub_16(acc[k], vmovl_s8(vget_low_s8(column[k / 2])));
+                acc[k + 1] = vec_sub_16(acc[k + 1], vmovl_high_s8(column[k / 2]));
+            }
+    #else
+            for (IndexType k = 0; k < Tiling::NumRegs; ++k)
+                acc[k] = vec_sub_16(acc[k], vec_convert_8_16(column[k]));
+    #endif
+        }
+        for (const auto index : threatAdded)
+        {
+            auto* column = reinterpret_cast<const vec_i8_t*>(
+              &featureTransformer.threatWeights[Dimensions * index + tile]);
+    #ifdef USE_NEON
+            for (IndexType k = 0; k < Tiling::NumRegs; k += 2)
+            {
+                acc[k]     = vec_add_16(acc[k], vmovl_s8(vget_low_s8(column[k / 2])));
+                acc[k + 1] = vec_add_16(acc[k + 1], vmovl_high_s8(column[k / 2]));
+            }
+    #else
+            for (IndexType k = 0; k < Tiling::NumRegs; ++k)
+                acc[k] = vec_add_16(acc[k], vec_convert_8_16(column[k]));
+    #endif
+        }
+
+        auto* threatToTile = reinterpret_cast<vec_t*>(&threatTo.accumulation[Perspective][tile]);
+        for (IndexType k = 0; k < Tiling::NumRegs; ++k)
+            vec_store(&threatToTile[k], acc[k]);
+    }
+
+    for (IndexType j = 0; j < PSQTBuckets / Tiling::PsqtTileHeight; ++j)
+    {
+        const IndexType tile = j * Tiling::PsqtTileHeight;
+
+        auto apply = [&](const auto& from, auto& to, const auto& removed, const auto& added,
+                         const PSQTWeightType* weights) {
+            auto* fromTile = reinterpret_cast<const psqt_vec_t*>(&from[tile]);
+            for (IndexType k = 0; k < Tiling::NumPsqtRegs; ++k)
+                psqt[k] = fromTile[k];
+
+            for (const auto index : removed)
+            {
+                auto* column =
+                  reinterpret_cast<const psqt_vec_t*>(&weights[PSQTBuckets * index + tile]);
+                for (IndexType k = 0; k < Tiling::NumPsqtRegs; ++k)
+                    psqt[k] = vec_sub_psqt_32(psqt[k], column[k]);
+            }
+            for (const auto index : added)
+            {
+                auto* column =
+                  reinterpret_cast<const psqt_vec_t*>(&weights[PSQTBuckets * index + tile]);
+                for (IndexType k = 0; k < Tiling::NumPsqtRegs; ++k)
+                    psqt[k] = vec_add_psqt_32(psqt[k], column[k]);
+            }
+
+            auto* toTile = reinterpret_cast<psqt_vec_t*>(&to[tile]);
+            for (IndexType k = 0; k < Tiling::NumPsqtRegs; ++k)
+                vec_store_psqt(&toTile[k], psqt[k]);
+        };
+
+        apply(psqComputed.acc<Dimensions>().psqtAccumulation[Perspective],
+              psqTo.psqtAccumulation[Perspective], psqRemoved, psqAdded,
+              featureTransformer.psqtWeights.data());
+        apply(threatComputed.acc<Dimensions>().psqtAccumulation[Perspective],
+              threatTo.psqtAccumulation[Perspective], threatRemoved, threatAdded,
+              featureTransformer.threatPsqtWeights.data());
+    }
+
+    psqTo.computed[Perspective]    = true;
+    threatTo.computed[Perspective] = true;
+
+#else
+
+    update_accumulator_incremental<Perspective, true>(featureTransformer, ksq, psqTarget,
+                                                      psqComputed);
+    update_accumulator_incremental<Perspective, true>(featureTransformer, ksq, threatTarget,
+                                                      threatComputed);
+
+#endif
+}
+
 Bitboard get_changed_pieces(const Piece oldPieces[SQUARE_NB], const Piece newPieces[SQUARE_NB]) {
 #if defined(USE_AVX512) || defined(USE_AVX2)
     static_assert(sizeof(Piece) == 1);
@@ -161,10 +161,20 @@ class AccumulatorStack {
     std::pair<DirtyPiece&, DirtyThreats&> push() noexcept;
     void                                  pop() noexcept;
 
+    // With fuseFeatureSets, the piece-square and threat accumulators of the big
+    // net that are one move behind are updated together. It measured no faster
+    // than the separate updates, so it is only turned on to compare with them.
     template<IndexType Dimensions>
     void evaluate(const Position&                       pos,
                   const FeatureTransformer<Dimensions>& featureTransformer,
-                  AccumulatorCaches::Cache<Dimensions>& cache) noexcept;
+                  AccumulatorCaches::Cache<Dimensions>& cache,
+                  bool                                  fuseFeatureSets = false) noexcept;
+
+    // Prefetches the weight rows of the features changed by the latest move, so
+    // that the next evaluate() updates its accumulators from warm cache lines
+    template<IndexType Dimensions>
+    void prefetch_weights(const Position&                       pos,
+                          const FeatureTransformer<Dimensions>& featureTransformer) const noexcept;
 
    private:
     template<typename T>
@@ -184,6 +194,10 @@ class AccumulatorStack {
     template<Color Perspective, typename FeatureSet, IndexType Dimensions>
     [[nodiscard]] std::size_t find_last_usable_accumulator() const noexcept;
 
+    template<Color Perspective, IndexType Dimensions>
+    bool fused_update_incremental(
+      const Position& pos, const FeatureTransformer<Dimensions>& featureTransformer) noexcept;
+
     template<Color Perspective, typename FeatureSet, IndexType Dimensions>
     void forward_update_incremental(const Position&                       pos,
                                     const FeatureTransformer<Dimensions>& featureTransformer,
@@ -19,48 +19,193 @@
 #ifndef PERFT_H_INCLUDED
 #define PERFT_H_INCLUDED
 
+#include <atomic>
+#include <cstddef>
 #include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
 
+#include "memory.h"
 #include "movegen.h"
 #include "position.h"
+#include "thread.h"
 #include "types.h"
 #include "uci.h"
 
 namespace Stockfish::Benchmark {
 
+// Table of the leaf counts of the subtrees already counted, shared by all the
+// threads without locks. The key is stored xored with the data, so an entry
+// torn by concurrent writes fails the key check instead of giving a wrong count.
+class PerftTable {
+   public:
+    explicit PerftTable(size_t mbSize) {
+        size_t count = 1;
+        while (count * 2 * sizeof(Entry) <= mbSize * 1024 * 1024)
+            count *= 2;
+
+        table = make_unique_large_page<Entry[]>(count);
+        mask  = count - 1;
+    }
+
+    bool probe(Key key, Depth depth, uint64_t& nodes) const {
+        const Key      k    = depth_key(key, depth);
+        const Entry&   e    = table[k & mask];
+        const uint64_t data = e.data.load(std::memory_order_relaxed);
+
+        if ((e.check.load(std::memory_order_relaxed) ^ data) != k || Depth(data & 0xFF) != depth)
+            return false;
+
+        nodes = data >> 8;
+        return true;
+    }
+
+    void store(Key key, Depth depth, uint64_t nodes) {
+        const Key      k    = depth_key(key, depth);
+        Entry&         e    = table[k & mask];
+        const uint64_t data = nodes << 8 | uint64_t(depth);
+
+        e.check.store(k ^ data, std::memory_order_relaxed);
+        e.data.store(data, std::memory_order_relaxed);
+    }
+
+   private:
+    struct Entry {
+        std::atomic<uint64_t> check{0};
+        std::atomic<uint64_t> data{0};  // Leaf count in the upper 56 bits, depth in the lower 8
+    };
+
+    // Counts at different depths of the same position go to different entries
+    static Key depth_key(Key key, Depth depth) { return key ^ (depth * 0x9E3779B97F4A7C15ULL); }
+
+    LargePagePtr<Entry[]> table;
+    size_t                mask;
+};
+
 // Utility to verify move generation. All the leaf nodes up
 // to the given depth are generated and counted, and the sum is returned.
 template<bool Root>
-uint64_t perft(Position& pos, Depth depth) {
+uint64_t perft(Position& pos, Depth depth, PerftTable* table = nullptr) {
 
     StateInfo st;
 
     uint64_t   cnt, nodes = 0;
     const bool leaf = (depth == 2);
 
+    if (!Root && table && table->probe(pos.key(), depth, nodes))
+        return nodes;
+
     for (const auto& m : MoveList<LEGAL>(pos))
     {
         if (Root && depth <= 1)
             cnt = 1, nodes++;
         else
         {
-            pos.do_move(m, st);
-            cnt = leaf ? MoveList<LEGAL>(pos).size() : perft<false>(pos, depth - 1);
+            pos.do_light_move(m, st);
+            cnt = leaf ? MoveList<LEGAL>(pos).size() : perft<false>(pos, depth - 1, table);
             nodes += cnt;
             pos.undo_move(m);
         }
         if (Root)
             sync_cout << UCIEngine::move(m, pos.is_chess960()) << ": " << cnt << sync_endl;
     }
+
+    if (!Root && table)
+        table->store(pos.key(), depth, nodes);
+
     return nodes;
 }
 
-inline uint64_t perft(const std::string& fen, Depth depth, bool isChess960) {
+// Parallel perft. Every pair of a root move and a reply to it is a job, and the
+// threads of the pool take the jobs in turn, which balances the work much better
+// than giving whole root moves to the threads. The counts are summed per root
+// move, so the output is the same as the one of the sequential perft.
+inline uint64_t parallel_perft(
+  Position& root, Depth depth, ThreadPool& threads, size_t threadCount, PerftTable* table) {
+
+    struct Job {
+        size_t rootIdx;
+        Move   reply;
+    };
+
+    const std::string fen        = root.fen();
+    const bool        isChess960 = root.is_chess960();
+
+    std::vector<Move> rootMoves;
+    std::vector<Job>  jobs;
+    StateInfo         st;
+
+    for (const auto& m : MoveList<LEGAL>(root))
+    {
+        root.do_light_move(m, st);
+        for (const auto& reply : MoveList<LEGAL>(root))
+            jobs.push_back({rootMoves.size(), reply});
+        root.undo_move(m);
+
+        rootMoves.push_back(m);
+    }
+
+    std::vector<std::atomic<uint64_t>> counts(rootMoves.size());
+    std::atomic<size_t>                nextJob{0};
+
+    for (size_t t = 0; t < threadCount; ++t)
+        threads.run_on_thread(t, [&]() {
+            StateInfo rootSt, st1, st2;
+            Position  pos;
+            pos.set(fen, isChess960, &rootSt);
+
+            for (size_t j; (j = nextJob.fetch_add(1, std::memory_order_relaxed)) < jobs.size();)
+            {
+                const Move m = rootMoves[jobs[j].rootIdx];
+
+                pos.do_light_move(m, st1);
+                pos.do_light_move(jobs[j].reply, st2);
+
+                const uint64_t cnt = depth == 3 ? MoveList<LEGAL>(pos).size()
+                                                : perft<false>(pos, depth - 2, table);
+
+                pos.undo_move(jobs[j].reply);
+                pos.undo_move(m);
+
+                counts[jobs[j].rootIdx].fetch_add(cnt, std::memory_order_relaxed);
+            }
+        });
+
+    for (size_t t = 0; t < threadCount; ++t)
+        threads.wait_on_thread(t);
+
+    uint64_t nodes = 0;
+
+    for (size_t i = 0; i < rootMoves.size(); ++i)
+    {
+        nodes += counts[i];
+        sync_cout << UCIEngine::move(rootMoves[i], isChess960) << ": " << counts[i] << sync_endl;
+    }
+
+    return nodes;
+}
+
+// Counts with threadCount threads of the pool, and with a perft table of hashMb
+// MiB unless it is 0. Small depths are not worth splitting.
+inline uint64_t perft(const std::string& fen,
+                      Depth              depth,
+                      bool               isChess960,
+                      ThreadPool&        threads,
+                      size_t             threadCount = 1,
+                      size_t             hashMb      = 0) {
     StateInfo st;
     Position  p;
     p.set(fen, isChess960, &st);
 
-    return perft<true>(p, depth);
+    std::unique_ptr<PerftTable> table;
+    if (hashMb)
+        table = std::make_unique<PerftTable>(hashMb);
+
+    if (threadCount > 1 && depth >= 3)
+        return parallel_perft(p, depth, threads, threadCount, table.get());
+
+    return perft<true>(p, depth, table.get());
 }
 }
 
@@ -27,11 +27,14 @@
 #include <initializer_list>
 #include <iomanip>
 #include <iostream>
+#include <iterator>
 #include <sstream>
 #include <string_view>
 #include <utility>
+#include <vector>
 
 #include "bitboard.h"
+#include "gamephase.h"
 #include "misc.h"
 #include "movegen.h"
 #include "syzygy/tbprobe.h"
@@ -295,6 +298,86 @@ Position& Position::set(const string& fenStr, bool isChess960, StateInfo* si) {
 }
 
 
+// Checks a FEN before Position::set(), which trusts its input: a malformed one
+// would set up pieces off the board or look for a missing king or castling rook.
+std::optional<string> Position::fen_error(const string& fen) {
+
+    std::istringstream  ss(fen);
+    std::vector<string> fields{std::istream_iterator<string>(ss), {}};
+
+    if (fields.size() < 4 || fields.size() > 6)
+        return "a FEN has 4 to 6 fields";
+
+    std::vector<string> ranks(1);
+    int                 kings[COLOR_NB] = {};
+
+    for (char token : fields[0])
+    {
+        size_t idx = PieceToChar.find(token);
+
+        if (token == '/')
+            ranks.emplace_back();
+
+        else if (token >= '1' && token <= '8')
+            ranks.back().append(size_t(token - '0'), '.');
+
+        else if (token != ' ' && idx != string::npos)
+        {
+            if (type_of(Piece(idx)) == PAWN && (ranks.size() == 1 || ranks.size() == 8))
+                return "a pawn is on the first or the last rank";
+
+            kings[color_of(Piece(idx))] += type_of(Piece(idx)) == KING;
+            ranks.back() += token;
+        }
+        else
+            return string("invalid piece '") + token + "'";
+
+        if (ranks.size() > 8 || ranks.back().size() > 8)
+            return "the board is not of 8 ranks of 8 squares";
+    }
+
+    if (ranks.size() != 8 || std::any_of(ranks.begin(), ranks.end(),
+                                         [](const string& r) { return r.size() != 8; }))
+        return "the board is not of 8 ranks of 8 squares";
+
+    if (kings[WHITE] != 1 || kings[BLACK] != 1)
+        return "there is not exactly one king per side";
+
+    if (fields[1] != "w" && fields[1] != "b")
+        return "the side to move is not 'w' or 'b'";
+
+    // With 'K' and 'Q' the rook is looked for on the back rank
+    if (fields[2] != "-")
+        for (char token : fields[2])
+        {
+            const bool    black = islower(static_cast<unsigned char>(token));
+            const string& rank  = black ? ranks[0] : ranks[7];
+            const char    upper = char(toupper(static_cast<unsigned char>(token)));
+
+            if (upper != 'K' && upper != 'Q' && (upper < 'A' || upper > 'H'))
+                return string("invalid castling right '") + token + "'";
+
+            if ((upper == 'K' || upper == 'Q') && rank.find(black ? 'r' : 'R') == string::npos)
+                return string("no rook for the castling right '") + token + "'";
+        }
+
+    for (size_t i = 4; i < fields.size(); ++i)
+        if (!std::all_of(fields[i].begin(), fields[i].end(),
+                         [](char c) { return std::isdigit(static_cast<unsigned char>(c)); }))
+            return "the move counters are not numbers";
+
+    StateInfo st;
+    Position  pos;
+    pos.set(fen, false, &st);
+
+    if (pos.attackers_to_exist(pos.square<KING>(~pos.side_to_move()), pos.pieces(),
+                               pos.side_to_move()))
+        return "the side not to move is in check";
+
+    return std::nullopt;
+}
+
+
 // Helper function used to set castling
 // rights given the corresponding color and the rook starting square.
 void Position::set_castling_right(Color c, Square rfrom) {
@@ -376,6 +459,8 @@ void Position::set_state() const {
 
     st->key ^= Zobrist::castling[st->castlingRights];
     st->materialKey = compute_material_key();
+
+    st->materialPhase = material_phase(non_pawn_material(), count<ALL_PIECES>() - 2);
 }
 
 Key Position::compute_material_key() const {
@@ -699,10 +784,29 @@ void Position::do_move(Move                      m,
                        DirtyPiece&               dp,
                        DirtyThreats&             dts,
                        const TranspositionTable* tt = nullptr) {
+    do_move_impl<false>(m, newSt, givesCheck, dp, dts, tt);
+}
+
+// Makes a move like do_move(), but without updating the threats for NNUE,
+// a large part of the cost of a move. For perft and the other users of the
+// position that never evaluate it. The keys and the check info are updated.
+void Position::do_light_move(Move m, StateInfo& newSt) {
+    do_move_impl<true>(m, newSt, gives_check(m), scratch_dp, scratch_dts, nullptr);
+}
+
+template<bool Light>
+void Position::do_move_impl(Move                      m,
+                            StateInfo&                newSt,
+                            bool                      givesCheck,
+                            DirtyPiece&               dp,
+                            DirtyThreats&             dts,
+                            const TranspositionTable* tt) {
 
     assert(m.is_ok());
     assert(&newSt != st);
 
+    DirtyThreats* const dirtyThreats = Light ? nullptr : &dts;
+
     Key k = st->key ^ Zobrist::side;
 
     // Copy some fields of the old state to our new StateInfo object except the
@@ -731,9 +835,13 @@ void Position::do_move(Move                      m,
     dp.from           = from;
     dp.to             = to;
     dp.add_sq         = SQ_NONE;
-    dts.us            = us;
-    dts.prevKsq       = square<KING>(us);
-    dts.threatenedSqs = dts.threateningSqs = 0;
+
+    if constexpr (!Light)
+    {
+        dts.us            = us;
+        dts.prevKsq       = square<KING>(us);
+        dts.threatenedSqs = dts.threateningSqs = 0;
+    }
 
     assert(color_of(pc) == us);
     assert(captured == NO_PIECE || color_of(captured) == (m.type_of() != CASTLING ? them : us));
@@ -745,7 +853,7 @@ void Position::do_move(Move                      m,
         assert(captured == make_piece(us, ROOK));
 
         Square rfrom, rto;
-        do_castling<true>(us, from, to, rfrom, rto, &dts, &dp);
+        do_castling<true>(us, from, to, rfrom, rto, dirtyThreats, &dp);
 
         k ^= Zobrist::psq[captured][rfrom] ^ Zobrist::psq[captured][rto];
         st->nonPawnKey[us] ^= Zobrist::psq[captured][rfrom] ^ Zobrist::psq[captured][rto];
@@ -770,7 +878,7 @@ void Position::do_move(Move                      m,
                 assert(piece_on(capsq) == make_piece(them, PAWN));
 
                 // Update board and piece lists in ep case, normal captures are updated later
-                remove_piece(capsq, &dts);
+                remove_piece(capsq, dirtyThreats);
             }
 
             st->pawnKey ^= Zobrist::psq[captured][capsq];
@@ -820,11 +928,11 @@ void Position::do_move(Move                      m,
     {
         if (captured && m.type_of() != EN_PASSANT)
         {
-            remove_piece(from, &dts);
-            swap_piece(to, pc, &dts);
+            remove_piece(from, dirtyThreats);
+            swap_piece(to, pc, dirtyThreats);
         }
         else
-            move_piece(from, to, &dts);
+            move_piece(from, to, dirtyThreats);
     }
 
     // If the moving piece is a pawn do some special extra work
@@ -842,7 +950,7 @@ void Position::do_move(Move                      m,
             assert(relative_rank(us, to) == RANK_8);
             assert(type_of(promotion) >= KNIGHT && type_of(promotion) <= QUEEN);
 
-            swap_piece(to, promotion, &dts);
+            swap_piece(to, promotion, dirtyThreats);
 
             dp.add_pc = promotion;
             dp.add_sq = to;
@@ -883,6 +991,10 @@ void Position::do_move(Move                      m,
     // Set capture piece
     st->capturedPiece = captured;
 
+    // CAPABLANCA ENHANCED: The material phase only changes with the material
+    if (captured || m.type_of() == PROMOTION)
+        st->materialPhase = material_phase(non_pawn_material(), count<ALL_PIECES>() - 2);
+
     // Calculate checkers bitboard (if move gives check)
     st->checkersBB = givesCheck ? attackers_to(square<KING>(them)) & pieces(us) : 0;
 
@@ -967,7 +1079,8 @@ void Position::do_move(Move                      m,
         }
     }
 
-    dts.ksq = square<KING>(us);
+    if constexpr (!Light)
+        dts.ksq = square<KING>(us);
 
     assert(pos_is_ok());
 
@@ -25,6 +25,7 @@
 #include <iosfwd>
 #include <memory>
 #include <new>
+#include <optional>
 #include <string>
 
 #include "bitboard.h"
@@ -51,6 +52,9 @@ struct StateInfo {
     int    pliesFromNull;
     Square epSquare;
 
+    // CAPABLANCA ENHANCED: Updated on captures and promotions only
+    MaterialPhase materialPhase;
+
     // Not copied when making a move (will be recomputed anyhow)
     Key        key;
     Bitboard   checkersBB;
@@ -87,6 +91,11 @@ class Position {
     Position&   set(const std::string& code, Color c, StateInfo* si);
     std::string fen() const;
 
+    // Why set() cannot take the FEN, if so. It has 4 to 6 fields, 8 ranks of 8
+    // squares, one king per side, a side to move 'w' or 'b', castling rooks and
+    // the side not to move not in check.
+    static std::optional<std::string> fen_error(const std::string& fen);
+
     // Position representation
     Bitboard pieces() const;  // All pieces
     template<typename... PieceTypes>
@@ -141,6 +150,7 @@ class Position {
                  DirtyPiece&               dp,
                  DirtyThreats&             dts,
                  const TranspositionTable* tt);
+    void do_light_move(Move m, StateInfo& newSt);
     void undo_move(Move m);
     void do_null_move(StateInfo& newSt, const TranspositionTable& tt);
     void undo_null_move();
@@ -157,8 +167,9 @@ class Position {
 
     // Other properties of the position
     Color side_to_move() const;
-    int   game_ply() const;
-    bool  is_chess960() const;
+    int       game_ply() const;
+    GamePhase game_phase() const;
+    bool      is_chess960() const;
     bool  is_draw(int ply) const;
     bool  is_repetition(int ply) const;
     bool  upcoming_repetition(int ply) const;
@@ -186,6 +197,13 @@ class Position {
     void set_check_info() const;
 
     // Other helpers
+    template<bool Light>
+    void do_move_impl(Move                      m,
+                      StateInfo&                newSt,
+                      bool                      givesCheck,
+                      DirtyPiece&               dp,
+                      DirtyThreats&             dts,
+                      const TranspositionTable* tt);
     template<bool PutPiece, bool ComputeRay = true>
     void update_piece_threats(Piece pc, Square s, DirtyThreats* const dts);
     void move_piece(Square from, Square to, DirtyThreats* const dts = nullptr);
@@ -323,6 +341,12 @@ inline Value Position::non_pawn_material() const {
 
 inline int Position::game_ply() const { return gamePly; }
 
+inline GamePhase Position::game_phase() const {
+    return st->materialPhase.phase == OPENING && gamePly >= st->materialPhase.openingPlies
+           ? MIDDLEGAME
+           : st->materialPhase.phase;
+}
+
 inline int Position::rule50_count() const { return st->rule50; }
 
 inline bool Position::is_chess960() const { return chess960; }
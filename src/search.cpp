@@ -157,6 +157,7 @@ Search::Worker::Worker(SharedState&                    sharedState,
     tt(sharedState.tt),
     networks(sharedState.networks),
     refreshTable(networks[token]) {
+    stopFlag = &threads.stop;
     clear();
 }
 
@@ -177,10 +178,26 @@ void Search::Worker::start_searching() {
         return;
     }
 
+    if (main_manager()->updates.onSearchStart)
+        main_manager()->updates.onSearchStart();
+
     main_manager()->tm.init(limits, rootPos.side_to_move(), rootPos.game_ply(), options,
                             main_manager()->originalTimeAdjust);
     tt.new_search();
 
+    // The same time limits as in check_time(), in 'nodes as time' mode it checks the nodes
+    TimePoint timeLimit = limits.use_time_management() ? main_manager()->tm.maximum() + 1 : 0;
+    if (limits.movetime)
+        timeLimit = timeLimit ? std::min(timeLimit, limits.movetime) : limits.movetime;
+
+    main_manager()->firstIterationDone = false;
+
+    if (options["TimerThread"] && timeLimit && !limits.npmsec)
+        main_manager()->stopTimer.start(limits.startTime + timeLimit, [this]() {
+            if (main_manager()->firstIterationDone && !main_manager()->ponder)
+                threads.stop = threads.abortedSearch = true;
+        });
+
     if (rootMoves.empty())
     {
         rootMoves.emplace_back(Move::none());
@@ -204,6 +221,7 @@ void Search::Worker::start_searching() {
     // Stop the threads if not already stopped (also raise the stop if
     // "ponderhit" just reset threads.ponder)
     threads.stop = true;
+    main_manager()->stopTimer.cancel();
 
     // Wait until all threads have finished
     threads.wait_for_search_finished();
@@ -239,6 +257,74 @@ void Search::Worker::start_searching() {
     main_manager()->updates.onBestmove(bestmove, ponder);
 }
 
+Search::AnalysisResult Search::Worker::analyze(const std::string& fen,
+                                               bool               isChess960,
+                                               const LimitsType&  analysisLimits) {
+
+    std::atomic_bool stop{false};
+
+    limits = analysisLimits;
+    nodes = tbHits = nmpMinPly = bestMoveChanges = 0;
+    publishedNodes                               = nullptr;
+    ttLocalProbes = ttRemoteProbes = 0;
+    rootDepth = completedDepth = 0;
+
+    rootPos.set(fen, isChess960, &rootState);
+
+    rootMoves.clear();
+    for (const auto& m : MoveList<LEGAL>(rootPos))
+        rootMoves.emplace_back(m);
+
+    if (rootMoves.empty())
+        return {0, {rootPos.checkers() ? -VALUE_MATE : VALUE_DRAW, rootPos}, 0, {}};
+
+    tbConfig = TB::rank_root_moves(options, rootPos, rootMoves);
+
+    standalone = true;
+    stopFlag   = &stop;
+
+    accumulatorStack.reset();
+    iterative_deepening();
+
+    standalone = false;
+    stopFlag   = &threads.stop;
+
+    // The score of the best move as the PV output gives it
+    const RootMove& rm = rootMoves[0];
+    Value v = rm.score != -VALUE_INFINITE ? rm.uciScore : rm.previousScore;
+
+    if (v == -VALUE_INFINITE)
+        v = VALUE_ZERO;
+
+    if (tbConfig.rootInTB && std::abs(v) <= VALUE_TB)
+        v = rm.tbScore;
+
+    return {completedDepth, {v, rootPos}, nodes, rm.pv};
+}
+
+Value Search::Worker::static_eval(const std::string& fen,
+                                  bool               isChess960,
+                                  Eval::NetSelection net) {
+
+    rootPos.set(fen, isChess960, &rootState);
+
+    if (rootPos.checkers())
+        return VALUE_NONE;
+
+    accumulatorStack.reset();
+
+    if (net == Eval::NetSelection::Auto)
+        return Eval::evaluate(networks[numaAccessToken], rootPos, accumulatorStack, refreshTable,
+                              evalCache, VALUE_ZERO);
+
+    auto [psqt, positional] =
+      net == Eval::NetSelection::Small
+        ? networks[numaAccessToken].small.evaluate(rootPos, accumulatorStack, refreshTable.small)
+        : networks[numaAccessToken].big.evaluate(rootPos, accumulatorStack, refreshTable.big);
+
+    return psqt + positional;
+}
+
 // Main iterative deepening loop. It calls search()
 // repeatedly with increasing depth until the allocated thinking time has been
 // consumed, the user stops the search, or the maximum search depth is reached.
@@ -300,8 +386,8 @@ void Search::Worker::iterative_deepening() {
     lowPlyHistory.fill(97);
 
     // Iterative deepening loop until requested to stop or the target depth is reached
-    while (++rootDepth < MAX_PLY && !threads.stop
-           && !(limits.depth && mainThread && rootDepth > limits.depth))
+    while (++rootDepth < MAX_PLY && !*stopFlag
+           && !(limits.depth && (mainThread || standalone) && rootDepth > limits.depth))
     {
         // Age out PV variability metric
         if (mainThread)
@@ -333,8 +419,7 @@ void Search::Worker::iterative_deepening() {
             selDepth = 0;
 
             // CAPABLANCA ENHANCED: Adaptive aspiration window based on game phase
-            GamePhase phase = detect_game_phase(rootPos);
-            PhaseParams params = get_phase_params(phase);
+            const PhaseParams& params = get_phase_params(rootPos.game_phase());
 
             // Reset aspiration window starting size (phase-adaptive)
             int baseDelta = 5 + threadIdx % 8 + std::abs(rootMoves[pvIdx].meanSquaredScore) / 9000;
@@ -351,7 +436,7 @@ void Search::Worker::iterative_deepening() {
             // Start with a small aspiration window and, in the case of a fail
             // high/low, re-search with a bigger window until we don't fail
             // high/low anymore.
-            int failedHighCnt = 0;
+            int failedHighCnt = 0, failedCnt = 0;
             while (true)
             {
                 // Adjust the effective depth searched, but ensure at least one
@@ -359,7 +444,12 @@ void Search::Worker::iterative_deepening() {
                 Depth adjustedDepth =
                   std::max(1, rootDepth - failedHighCnt - 3 * (searchAgainCounter + 1) / 4);
                 rootDelta = beta - alpha;
-                bestValue = search<Root>(rootPos, ss, alpha, beta, adjustedDepth, false);
+                bestValue =
+                  backend == SearchBackend::V3
+                    ? search<Root, SearchBackend::V3>(rootPos, ss, alpha, beta, adjustedDepth,
+                                                      false)
+                    : search<Root, SearchBackend::Classic>(rootPos, ss, alpha, beta, adjustedDepth,
+                                                           false);
 
                 // Bring the best move to the front. It is critical that sorting
                 // is done with a stable algorithm because all the values but the
@@ -372,7 +462,7 @@ void Search::Worker::iterative_deepening() {
                 // If search has been stopped, we break immediately. Sorting is
                 // safe because RootMoves is still valid, although it refers to
                 // the previous iteration.
-                if (threads.stop)
+                if (*stopFlag)
                     break;
 
                 // When failing high/low give some update before a re-search. To avoid
@@ -402,7 +492,8 @@ void Search::Worker::iterative_deepening() {
                 else
                     break;
 
-                delta += delta / 3;
+                // The v3 backend widens the window faster after repeated fails
+                delta += backend == SearchBackend::V3 && ++failedCnt > 1 ? delta / 2 : delta / 3;
 
                 assert(alpha >= -VALUE_INFINITE && beta <= VALUE_INFINITE);
             }
@@ -420,13 +511,16 @@ void Search::Worker::iterative_deepening() {
                 && !(threads.abortedSearch && is_loss(rootMoves[0].uciScore)))
                 main_manager()->pv(*this, threads, tt, rootDepth);
 
-            if (threads.stop)
+            if (*stopFlag)
                 break;
         }
 
-        if (!threads.stop)
+        if (!*stopFlag)
             completedDepth = rootDepth;
 
+        if (mainThread && completedDepth >= 1)
+            mainThread->firstIterationDone = true;
+
         // We make sure not to pick an unproven mated-in score,
         // in case this thread prematurely stopped search (aborted-search).
         if (threads.abortedSearch && rootMoves[0].score != -VALUE_INFINITE
@@ -536,11 +630,17 @@ void Search::Worker::do_move(Position& pos, const Move move, StateInfo& st, Stac
 void Search::Worker::do_move(
   Position& pos, const Move move, StateInfo& st, const bool givesCheck, Stack* const ss) {
     bool capture = pos.capture_stage(move);
-    nodes.fetch_add(1, std::memory_order_relaxed);
+
+    if ((nodes.fetch_add(1, std::memory_order_relaxed) & (PublishedNodes::PublishPeriod - 1))
+        == PublishedNodes::PublishPeriod - 1)
+        publish_nodes();
 
     auto [dirtyPiece, dirtyThreats] = accumulatorStack.push();
     pos.do_move(move, st, givesCheck, dirtyPiece, dirtyThreats, &tt);
 
+    if (prefetchWeights)
+        networks[numaAccessToken].big.prefetch_weights(pos, accumulatorStack);
+
     if (ss != nullptr)
     {
         ss->currentMove = move;
@@ -596,11 +696,14 @@ void Search::Worker::clear() {
         reductions[i] += int(std::log(i / 32.0) * 64 / 128.0);
 
     refreshTable.clear(networks[numaAccessToken]);
+
+    evalCache.resize(options["EvalCache"]);
+    evalCache.clear();
 }
 
 
 // Main search function for both PV and non-PV nodes
-template<NodeType nodeType>
+template<NodeType nodeType, Search::SearchBackend Backend>
 Value Search::Worker::search(
   Position& pos, Stack* ss, Value alpha, Value beta, Depth depth, bool cutNode) {
 
@@ -643,9 +746,9 @@ Value Search::Worker::search(
     SearchedList capturesSearched;
     SearchedList quietsSearched;
 
-    // CAPABLANCA ENHANCED: Detect game phase for adaptive search
-    GamePhase phase = detect_game_phase(pos);
-    PhaseParams phaseParams = get_phase_params(phase);
+    // CAPABLANCA ENHANCED: Game phase for adaptive search, tracked by the position
+    const GamePhase    phase       = pos.game_phase();
+    const PhaseParams& phaseParams = get_phase_params(phase);
 
     // Step 1. Initialize node
     ss->inCheck   = pos.checkers();
@@ -659,6 +762,10 @@ Value Search::Worker::search(
     if (is_mainthread())
         main_manager()->check_time(*this);
 
+    // A standalone worker enforces its nodes limit itself
+    else if (standalone && limits.nodes && nodes.load(std::memory_order_relaxed) >= limits.nodes)
+        *stopFlag = true;
+
     // Used to send selDepth info to GUI (selDepth counts from 1, ply from 0)
     if (PvNode && selDepth < ss->ply + 1)
         selDepth = ss->ply + 1;
@@ -666,7 +773,7 @@ Value Search::Worker::search(
     if (likely(!rootNode))
     {
         // Step 2. Check for aborted search and immediate draw
-        if (unlikely(threads.stop.load(std::memory_order_relaxed) || pos.is_draw(ss->ply)
+        if (unlikely(stopFlag->load(std::memory_order_relaxed) || pos.is_draw(ss->ply)
             || ss->ply >= MAX_PLY))
             return (ss->ply >= MAX_PLY && !ss->inCheck) ? evaluate(pos) : value_draw(nodes);
 
@@ -694,7 +801,9 @@ Value Search::Worker::search(
     // Step 4. Transposition table lookup
     excludedMove                   = ss->excludedMove;
     posKey                         = pos.key();
-    auto [ttHit, ttData, ttWriter] = tt.probe(posKey);
+    auto [ttHit, ttData, ttWriter] = tt.probe(posKey, collectTTStats ? &ttStats : nullptr);
+    if (tt.is_numa_placed())
+        count_numa_probe(posKey);
     // Need further processing of the saved data
     ss->ttHit    = ttHit;
     ttData.move  = rootNode ? rootMoves[pvIdx].pv[0] : ttHit ? ttData.move : Move::none();
@@ -731,7 +840,7 @@ Value Search::Worker::search(
             if (depth >= 8 && ttData.move && pos.pseudo_legal(ttData.move) && pos.legal(ttData.move)
                 && !is_decisive(ttData.value))
             {
-                pos.do_move(ttData.move, st);
+                pos.do_light_move(ttData.move, st);
                 Key nextPosKey                             = pos.key();
                 auto [ttHitNext, ttDataNext, ttWriterNext] = tt.probe(nextPosKey);
                 pos.undo_move(ttData.move);
@@ -905,7 +1014,7 @@ Value Search::Worker::search(
         Depth R = phaseParams.nullMoveReductionBase + depth / 3;
         do_null_move(pos, st, ss);
 
-        Value nullValue = -search<NonPV>(pos, ss + 1, -beta, -beta + 1, depth - R, false);
+        Value nullValue = -search<NonPV, Backend>(pos, ss + 1, -beta, -beta + 1, depth - R, false);
 
         undo_null_move(pos);
 
@@ -921,7 +1030,7 @@ Value Search::Worker::search(
             // until ply exceeds nmpMinPly.
             nmpMinPly = ss->ply + 3 * (depth - R) / 4;
 
-            Value v = search<NonPV>(pos, ss, beta - 1, beta, depth - R, false);
+            Value v = search<NonPV, Backend>(pos, ss, beta - 1, beta, depth - R, false);
 
             nmpMinPly = 0;
 
@@ -969,8 +1078,8 @@ Value Search::Worker::search(
 
             // If the qsearch held, perform the regular search
             if (value >= probCutBeta && probCutDepth > 0)
-                value = -search<NonPV>(pos, ss + 1, -probCutBeta, -probCutBeta + 1, probCutDepth,
-                                       !cutNode);
+                value = -search<NonPV, Backend>(pos, ss + 1, -probCutBeta, -probCutBeta + 1,
+                                                probCutDepth, !cutNode);
 
             undo_move(pos, move);
 
@@ -986,6 +1095,16 @@ Value Search::Worker::search(
         }
     }
 
+    // Step 11a. Multi-cut (v3 backend only)
+    // At cut nodes, if several of the first moves fail high on a reduced search,
+    // one of them is expected to fail high on the full depth search too.
+    if constexpr (Backend == SearchBackend::V3)
+    {
+        if (cutNode && depth >= 8 && !excludedMove && !is_decisive(beta)
+            && multi_cut(pos, ss, beta, depth, ttData.move) >= beta)
+            return beta;
+    }
+
 moves_loop:  // When in check, search starts here
 
     // Step 12. A small Probcut idea
@@ -1091,8 +1210,11 @@ moves_loop:  // When in check, search starts here
                             + (*contHist[1])[movedPiece][move.to_sq()]
                             + pawnHistory[pawn_history_index(pos)][movedPiece][move.to_sq()];
 
-                // Continuation history based pruning
-                if (history < -4312 * depth)
+                // Continuation history based pruning, tighter at shallow depths
+                // for the v3 backend
+                const int historyMargin =
+                  Backend == SearchBackend::V3 && depth <= 3 ? 3072 : 4312;
+                if (history < -historyMargin * depth)
                     continue;
 
                 history += 76 * mainHistory[us][move.raw()] / 32;
@@ -1145,7 +1267,8 @@ moves_loop:  // When in check, search starts here
             Depth singularDepth = newDepth / 2;
 
             ss->excludedMove = move;
-            value = search<NonPV>(pos, ss, singularBeta - 1, singularBeta, singularDepth, cutNode);
+            value = search<NonPV, Backend>(pos, ss, singularBeta - 1, singularBeta, singularDepth,
+                                           cutNode);
             ss->excludedMove = Move::none();
 
             if (value < singularBeta)
@@ -1257,7 +1380,7 @@ moves_loop:  // When in check, search starts here
             Depth d = std::max(1, std::min(newDepth - r / 1024, newDepth + 2)) + PvNode;
 
             ss->reduction = newDepth - d;
-            value         = -search<NonPV>(pos, ss + 1, -(alpha + 1), -alpha, d, true);
+            value         = -search<NonPV, Backend>(pos, ss + 1, -(alpha + 1), -alpha, d, true);
             ss->reduction = 0;
 
             // Do a full-depth search when reduced LMR search fails high
@@ -1272,7 +1395,8 @@ moves_loop:  // When in check, search starts here
                 newDepth += doDeeperSearch - doShallowerSearch;
 
                 if (newDepth > d)
-                    value = -search<NonPV>(pos, ss + 1, -(alpha + 1), -alpha, newDepth, !cutNode);
+                    value = -search<NonPV, Backend>(pos, ss + 1, -(alpha + 1), -alpha, newDepth,
+                                                    !cutNode);
 
                 // Post LMR continuation history updates
                 update_continuation_histories(ss, movedPiece, move.to_sq(), 1365);
@@ -1287,8 +1411,9 @@ moves_loop:  // When in check, search starts here
                 r += 1118;
 
             // Note that if expected reduction is high, we reduce search depth here
-            value = -search<NonPV>(pos, ss + 1, -(alpha + 1), -alpha,
-                                   newDepth - (r > 3212) - (r > 4784 && newDepth > 2), !cutNode);
+            value = -search<NonPV, Backend>(pos, ss + 1, -(alpha + 1), -alpha,
+                                            newDepth - (r > 3212) - (r > 4784 && newDepth > 2),
+                                            !cutNode);
         }
 
         // For PV nodes only, do a full PV search on the first move or after a fail high,
@@ -1305,7 +1430,7 @@ moves_loop:  // When in check, search starts here
                     || (ttData.depth > 1 && rootDepth > 8)))
                 newDepth = std::max(newDepth, 1);
 
-            value = -search<PV>(pos, ss + 1, -beta, -alpha, newDepth, false);
+            value = -search<PV, Backend>(pos, ss + 1, -beta, -alpha, newDepth, false);
         }
 
         // Step 19. Undo move
@@ -1317,7 +1442,7 @@ moves_loop:  // When in check, search starts here
         // Finished searching the move. If a stop occurred, the return value of
         // the search cannot be trusted, and we return immediately without updating
         // best move, principal variation nor transposition table.
-        if (threads.stop.load(std::memory_order_relaxed))
+        if (stopFlag->load(std::memory_order_relaxed))
             return VALUE_ZERO;
 
         if (rootNode)
@@ -1504,6 +1629,11 @@ moves_loop:  // When in check, search starts here
     return bestValue;
 }
 
+// The multi-cut of the v3 backend, in search_v3_integration.cpp, searches the moves
+// of a cut node with this instantiation
+template Value Search::Worker::search<NonPV, Search::SearchBackend::V3>(
+  Position& pos, Stack* ss, Value alpha, Value beta, Depth depth, bool cutNode);
+
 
 // Quiescence search function, which is called by the main search function with
 // depth zero, or recursively with further decreasing depth. With depth <= 0, we
@@ -1560,7 +1690,9 @@ Value Search::Worker::qsearch(Position& pos, Stack* ss, Value alpha, Value beta)
 
     // Step 3. Transposition table lookup
     posKey                         = pos.key();
-    auto [ttHit, ttData, ttWriter] = tt.probe(posKey);
+    auto [ttHit, ttData, ttWriter] = tt.probe(posKey, collectTTStats ? &ttStats : nullptr);
+    if (tt.is_numa_placed())
+        count_numa_probe(posKey);
     // Need further processing of the saved data
     ss->ttHit    = ttHit;
     ttData.move  = ttHit ? ttData.move : Move::none();
@@ -1764,14 +1896,32 @@ Depth Search::Worker::reduction(bool i, Depth d, int mn, int delta) const {
 // This function is intended for use only when printing PV outputs, and not used
 // for making decisions within the search algorithm itself.
 TimePoint Search::Worker::elapsed() const {
-    return main_manager()->tm.elapsed([this]() { return threads.nodes_searched(); });
+    return main_manager()->tm.elapsed([this]() { return threads.nodes_searched_approx(); });
 }
 
 TimePoint Search::Worker::elapsed_time() const { return main_manager()->tm.elapsed_time(); }
 
 Value Search::Worker::evaluate(const Position& pos) {
     return Eval::evaluate(networks[numaAccessToken], pos, accumulatorStack, refreshTable,
-                          optimism[pos.side_to_move()]);
+                          evalCache, optimism[pos.side_to_move()]);
+}
+
+// Counts whether the cluster of a probed key lies on the NUMA node of this thread.
+// Only this thread writes the counters, so they need no atomic increment.
+void Search::Worker::count_numa_probe(Key key) {
+    auto& counter =
+      tt.numa_node_of(key) == numaAccessToken.get_numa_index() ? ttLocalProbes : ttRemoteProbes;
+    counter.store(counter.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+}
+
+// Adds the nodes searched since the last call to the counter of the NUMA node
+void Search::Worker::publish_nodes() {
+    if (!publishedNodes)
+        return;
+
+    const uint64_t n = nodes.load(std::memory_order_relaxed);
+    publishedNodes->nodes.fetch_add(n - nodesPublished, std::memory_order_relaxed);
+    nodesPublished = n;
 }
 
 namespace {
@@ -1960,7 +2110,8 @@ void SearchManager::check_time(Search::Worker& worker) {
 
     static TimePoint lastInfoTime = now();
 
-    TimePoint elapsed = tm.elapsed([&worker]() { return worker.threads.nodes_searched(); });
+    TimePoint elapsed =
+      tm.elapsed([&worker]() { return worker.threads.nodes_searched_approx(); });
     TimePoint tick    = worker.limits.startTime + elapsed;
 
     if (tick - lastInfoTime >= 1000)
@@ -1979,7 +2130,7 @@ void SearchManager::check_time(Search::Worker& worker) {
       worker.completedDepth >= 1
       && ((worker.limits.use_time_management() && (elapsed > tm.maximum() || stopOnPonderhit))
           || (worker.limits.movetime && elapsed >= worker.limits.movetime)
-          || (worker.limits.nodes && worker.threads.nodes_searched() >= worker.limits.nodes)))
+          || (worker.limits.nodes && worker.threads.nodes_searched_approx() >= worker.limits.nodes)))
         worker.threads.stop = worker.threads.abortedSearch = true;
 }
 
@@ -31,6 +31,8 @@
 #include <string_view>
 #include <vector>
 
+#include "evalcache.h"
+#include "evaluate.h"
 #include "history.h"
 #include "misc.h"
 #include "nnue/network.h"
@@ -40,6 +42,7 @@
 #include "score.h"
 #include "syzygy/tbprobe.h"
 #include "timeman.h"
+#include "tt.h"
 #include "types.h"
 
 namespace Stockfish {
@@ -116,7 +119,7 @@ struct LimitsType {
     LimitsType() {
         time[WHITE] = time[BLACK] = inc[WHITE] = inc[BLACK] = npmsec = movetime = TimePoint(0);
         movestogo = depth = mate = perft = infinite = 0;
-        nodes                                       = 0;
+        nodes = perftThreads = perftHash            = 0;
         ponderMode                                  = false;
     }
 
@@ -126,6 +129,7 @@ struct LimitsType {
     TimePoint                time[COLOR_NB], inc[COLOR_NB], npmsec, movetime, startTime;
     int                      movestogo, depth, mate, perft, infinite;
     uint64_t                 nodes;
+    size_t                   perftThreads, perftHash;  // 0 threads uses the whole pool
     bool                     ponderMode;
 };
 
@@ -150,6 +154,14 @@ struct SharedState {
 
 class Worker;
 
+// The search variants that can be selected with the SearchBackend option. The v3
+// backend is the classic search plus the pruning and aspiration changes from the
+// v3 optimization set, each compiled as its own instantiation of search().
+enum class SearchBackend {
+    Classic,
+    V3
+};
+
 // Null Object Pattern, implement a common interface for the SearchManagers.
 // A Null Object will be given to non-mainthread workers.
 class ISearchManager {
@@ -182,6 +194,15 @@ struct InfoIteration {
     size_t           currmovenumber;
 };
 
+// The outcome of the search of one position of a batch analysis. A position
+// without legal moves has an empty PV and a depth of 0.
+struct AnalysisResult {
+    Depth             depth;
+    Score             score;
+    uint64_t          nodes;
+    std::vector<Move> pv;
+};
+
 // Skill structure is used to implement strength limit. If we have a UCI_Elo,
 // we convert it to an appropriate skill level, anchored to the Stash engine.
 // This method is based on a fit of the Elo results for games played between
@@ -218,12 +239,15 @@ class SearchManager: public ISearchManager {
     using UpdateFull     = std::function<void(const InfoFull&)>;
     using UpdateIter     = std::function<void(const InfoIteration&)>;
     using UpdateBestmove = std::function<void(std::string_view, std::string_view)>;
+    using UpdateStart    = std::function<void()>;
 
     struct UpdateContext {
         UpdateShort    onUpdateNoMoves;
         UpdateFull     onUpdateFull;
         UpdateIter     onIter;
         UpdateBestmove onBestmove;
+        // Called by the main thread before the search starts, which may wait there
+        UpdateStart onSearchStart;
     };
 
 
@@ -242,6 +266,11 @@ class SearchManager: public ISearchManager {
     int                       callsCnt;
     std::atomic_bool          ponder;
 
+    // With the TimerThread option, stops the search at the time limit. It cannot
+    // stop it before the first iteration is completed, then check_time() does.
+    DeadlineTimer    stopTimer;
+    std::atomic_bool firstIterationDone;
+
     std::array<Value, 4> iterValue;
     double               previousTimeReduction;
     Value                bestPreviousScore;
@@ -258,6 +287,15 @@ class NullSearchManager: public ISearchManager {
     void check_time(Search::Worker&) override {}
 };
 
+// The nodes searched by the threads of one NUMA node, on a cache line of its own.
+// Each thread adds its nodes every PublishPeriod nodes, so that the main thread
+// reads one line per NUMA node, instead of one per thread, to count the nodes.
+struct alignas(64) PublishedNodes {
+    static constexpr uint64_t PublishPeriod = 1024;
+
+    std::atomic<uint64_t> nodes{0};
+};
+
 
 // Search::Worker is the class that does the actual search.
 // It is instantiated once per thread, and it is responsible for keeping track
@@ -274,7 +312,17 @@ class Worker {
     // It searches from the root position and outputs the "bestmove".
     void start_searching();
 
-    bool is_mainthread() const { return threadIdx == 0; }
+    // A standalone worker searches alone, so even the first one is not the main thread
+    bool is_mainthread() const { return threadIdx == 0 && !standalone; }
+
+    // Searches the position alone, independently of the other threads of the pool,
+    // until the depth or nodes limit. The TT and the histories are kept.
+    AnalysisResult analyze(const std::string& fen, bool isChess960, const LimitsType& limits);
+
+    // Static evaluation of the position, from the point of view of the side to move,
+    // reusing the accumulators and the refresh table of the worker. VALUE_NONE if the
+    // side to move is in check. The raw network output unless the network is Auto.
+    Value static_eval(const std::string& fen, bool isChess960, Eval::NetSelection net);
 
     void ensure_network_replicated();
 
@@ -304,9 +352,12 @@ class Worker {
     void undo_null_move(Position& pos);
 
     // This is the main search function, for both PV and non-PV nodes
-    template<NodeType nodeType>
+    template<NodeType nodeType, SearchBackend Backend>
     Value search(Position& pos, Stack* ss, Value alpha, Value beta, Depth depth, bool cutNode);
 
+    // Multi-cut pruning at cut nodes, used by the v3 backend only
+    Value multi_cut(Position& pos, Stack* ss, Value beta, Depth depth, Move ttMove);
+
     // Quiescence search function, which is called by the main search
     template<NodeType nodeType>
     Value qsearch(Position& pos, Stack* ss, Value alpha, Value beta);
@@ -324,10 +375,20 @@ class Worker {
 
     Value evaluate(const Position&);
 
+    void count_numa_probe(Key key);
+    void publish_nodes();
+
     LimitsType limits;
 
     size_t                pvIdx, pvLast;
     std::atomic<uint64_t> nodes, tbHits, bestMoveChanges;
+    std::atomic<uint64_t> ttLocalProbes, ttRemoteProbes;
+    PublishedNodes*       publishedNodes = nullptr;  // Of the NUMA node of the thread
+    uint64_t              nodesPublished = 0;
+    TTStats               ttStats;
+    bool                  collectTTStats  = false;
+    bool                  prefetchWeights = false;
+    SearchBackend         backend         = SearchBackend::Classic;
     int                   selDepth, nmpMinPly;
 
     Value optimism[COLOR_NB];
@@ -341,6 +402,11 @@ class Worker {
     size_t                    threadIdx;
     NumaReplicatedAccessToken numaAccessToken;
 
+    // The flag that aborts the search: the one of the pool, or the worker's own one
+    // while it searches a position of a batch analysis alone
+    std::atomic_bool* stopFlag;
+    bool              standalone = false;
+
     // Reductions lookup table initialized at startup
     std::array<int, MAX_MOVES> reductions;  // [depth or moveNumber]
 
@@ -358,6 +424,10 @@ class Worker {
     Eval::NNUE::AccumulatorStack  accumulatorStack;
     Eval::NNUE::AccumulatorCaches refreshTable;
 
+    // Sized by the EvalCache option, and allocated by the thread itself so that
+    // its memory is local to the NUMA node the thread runs on
+    EvalCache evalCache;
+
     friend class Stockfish::ThreadPool;
     friend class SearchManager;
 };
@@ -1,506 +1,80 @@
 /*
-  Capablanca Chess Engine - v3.0/v4.0 Search Integration
+  Capablanca Chess Engine - v3.0 Search Integration
   Copyright (C) 2025 Capablanca Chess Engine Team
 
-  This file contains the integration of all v3.0 and v4.0 optimizations
-  into the main search function. It modifies the core alpha-beta search
-  with all 14+2 new techniques.
+  This file contains the parts of the v3.0 search backend that are not
+  shared with the classic search. The backend is selected at runtime with
+  the SearchBackend UCI option, and search() is compiled once for each
+  backend so that the classic search does not pay for the v3.0 checks.
 
-  USAGE:
-  1. Include this file after search.h
-  2. Replace calls to search<NT>() with search_v3<NT>() for v3.0
-  3. Replace calls to search<NT>() with search_v4<NT>() for v4.0
+  The v3.0 backend differs from the classic search by:
+  1. Tighter continuation history pruning of quiet moves at depth <= 3
+  2. Faster widening of the aspiration window after repeated fails
+  3. Multi-cut pruning at cut nodes (below)
 
-  Note: This is a REFERENCE IMPLEMENTATION. For production, these
-  modifications should be merged directly into search.cpp
+  Use 'bench_ab' to compare both backends on the same positions.
 */
 
+#include "movepick.h"
+#include "position.h"
 #include "search.h"
-#include "capablanca_v3_optimizations.h"
-#include "capablanca_v4_ml.h"
-#include "gamephase.h"
-#include "evalcache.h"
+#include "thread.h"
 
 namespace Stockfish {
 
-// ============================================================================
-// V3.0 SEARCH INTEGRATION
-// ============================================================================
+namespace {
 
-// Global v3.0 state (one per thread recommended)
-extern thread_local CapablancaV3State g_v3_state;
+// Multi-cut parameters: search up to MultiCutMoves moves with the depth reduced
+// by MultiCutReduction, and prune the node if MultiCutCutoffs of them fail high.
+constexpr int   MultiCutMoves     = 6;
+constexpr int   MultiCutCutoffs   = 3;
+constexpr Depth MultiCutReduction = 4;
 
-// Modified search function with all v3.0 optimizations
-template<NodeType nodeType>
-Value Search::Worker::search_v3(Position& pos, Stack* ss, Value alpha, Value beta,
-                                Depth depth, bool cutNode) {
+}  // namespace
 
-    // [... Keep existing Stockfish search preamble ...]
-    // This includes: Root check, depth check, draw detection, mate distance pruning
 
-    constexpr bool PvNode = nodeType != NonPV;
-    constexpr bool rootNode = nodeType == Root;
+// Multi-cut pruning. At an expected cut node, search the first moves with a
+// reduced depth. If several of them fail high, one of them will most probably
+// fail high on the full depth search too, so the node is pruned. Returns beta
+// in that case, and -VALUE_INFINITE otherwise.
+// See https://www.chessprogramming.org/Multi-Cut
+Value Search::Worker::multi_cut(Position& pos, Stack* ss, Value beta, Depth depth, Move ttMove) {
 
-    // Detect game phase (from v2.0)
-    GamePhase phase = detect_game_phase(pos);
-    PhaseParams phaseParams = get_phase_params(phase);
+    assert(depth > MultiCutReduction + 1);
 
-    // ... [Standard search initialization] ...
+    const PieceToHistory* contHist[] = {
+      (ss - 1)->continuationHistory, (ss - 2)->continuationHistory, (ss - 3)->continuationHistory,
+      (ss - 4)->continuationHistory, (ss - 5)->continuationHistory, (ss - 6)->continuationHistory};
 
-    // ========================================================================
-    // PHASE 1 OPTIMIZATIONS INTEGRATION
-    // ========================================================================
+    MovePicker mp(pos, ttMove, depth, &mainHistory, &lowPlyHistory, &captureHistory, contHist,
+                  &pawnHistory, ss->ply);
 
-    // Get move from TT
-    Move ttMove = // ... [standard TT probe] ...
+    StateInfo st;
+    Move      move;
+    int       moveCount = 0, cutoffs = 0;
 
-    // Initialize move picker
-    const PieceToHistory* contHist[] = { /* ... */ };
-    MovePicker mp(pos, ttMove, depth, &mainHistory, &lowPlyHistory,
-                  &captureHistory, contHist, &pawnHistory, ss->ply);
-
-    // Track killers with quality filter
-    Move killerMoves[2] = { ss->killers[0], ss->killers[1] };
-    Move mateKiller = Move::none();  // NEW: Separate mate killer slot
-
-    // Moves loop
-    Move move;
-    int moveCount = 0;
-    SearchedList quietsSearched, capturesSearched;
-
-    while ((move = mp.next_move()) != Move::none()) {
-        if (move == excludedMove || !pos.legal(move))
+    while (moveCount < MultiCutMoves && (move = mp.next_move()) != Move::none())
+    {
+        if (!pos.legal(move))
             continue;
 
-        moveCount++;
-        bool isCapture = pos.capture_stage(move);
-        bool givesCheck = pos.gives_check(move);
-        bool isQuiet = !isCapture && !givesCheck;
-        Piece movedPiece = pos.moved_piece(move);
-
-        // ====================================================================
-        // OPTIMIZATION 1: HISTORY-BASED PRUNING (+10-20 Elo)
-        // ====================================================================
-        if (isQuiet && depth <= HISTORY_PRUNING_DEPTH) {
-            int history = (*contHist[0])[movedPiece][move.to_sq()]
-                        + (*contHist[1])[movedPiece][move.to_sq()];
-
-            bool isKiller = (move == killerMoves[0] || move == killerMoves[1]);
-
-            if (should_prune_by_history(history, depth, ss->inCheck,
-                                       isCapture, move.is_promotion(), isKiller)) {
-                continue;  // PRUNED by history
-            }
-        }
-
-        // ====================================================================
-        // OPTIMIZATION 3: SEE-BASED PRUNING ENHANCEMENTS (+20-30 Elo)
-        // ====================================================================
-        if (SEEPruning::should_prune_by_see<PvNode>(pos, move, depth, ss->inCheck)) {
-            continue;  // PRUNED by SEE
-        }
-
-        // ====================================================================
-        // OPTIMIZATION 6: MULTI-CUT PRUNING (+12-20 Elo)
-        // ====================================================================
-        if (cutNode && depth >= MultiCutPruning::MIN_DEPTH && moveCount >= 2) {
-            // Check if we've had enough cutoffs
-            static int cutoffCount = 0;  // Track in this node
-
-            // Try reduced search
-            do_move(pos, move, st, givesCheck, ss);
-            Value mcValue = -search_v3<NonPV>(pos, ss+1, -beta, -beta+1,
-                                             depth - MultiCutPruning::REDUCTION, !cutNode);
-            undo_move(pos, move);
-
-            if (mcValue >= beta) {
-                cutoffCount++;
-                if (cutoffCount >= MultiCutPruning::M_CUTOFFS) {
-                    return beta;  // MULTI-CUT!
-                }
-            }
-
-            if (cutoffCount + (mp.remaining_moves()) < MultiCutPruning::M_CUTOFFS) {
-                // Can't reach M cutoffs with remaining moves
-                cutoffCount = 0;  // Reset for next node
-                // Don't break - continue normal search
-            }
-        }
-
-        // ... [Standard search continues] ...
-
-        // Perform the search
-        do_move(pos, move, st, givesCheck, ss);
-
-        // ... [Standard LMR, PVS, extensions, etc.] ...
-
-        Value value = -search_v3<NT>(pos, ss+1, -beta, -alpha, newDepth, !cutNode);
-
-        undo_move(pos, move);
-
-        // Update best move, alpha, etc.
-        if (value > bestValue) {
-            bestValue = value;
-
-            if (value > alpha) {
-                alpha = value;
-                bestMove = move;
-
-                // ============================================================
-                // OPTIMIZATION 2: KILLER QUALITY FILTERING (+5-8 Elo)
-                // ============================================================
-                if (isQuiet) {
-                    // Check if move qualifies as killer
-                    if (KillerQualityFilter::should_store_killer(beta, alpha, depth)) {
-                        // Mate killer separate slot
-                        if (KillerQualityFilter::is_mate_killer(value)) {
-                            mateKiller = move;
-                        } else {
-                            // Shift killers
-                            ss->killers[1] = ss->killers[0];
-                            ss->killers[0] = move;
-                        }
-                    }
-                }
-
-                // ============================================================
-                // OPTIMIZATION 5: COUNTERMOVE PAIR EXTENSION (+5-10 Elo)
-                // ============================================================
-                if (isQuiet && ss->ply >= 2) {
-                    Move oppMove1 = (ss-1)->currentMove;
-                    Move oppMove2 = (ss-2)->currentMove;
-                    if (oppMove1.is_ok() && oppMove2.is_ok()) {
-                        g_v3_state.countermovePairs[pos.side_to_move()].store(
-                            oppMove1, oppMove2, move
-                        );
-                    }
-                }
-
-                if (value >= beta)
-                    break;  // Beta cutoff
-            }
-        }
-    }
-
-    // ========================================================================
-    // PHASE 2 OPTIMIZATIONS INTEGRATION
-    // ========================================================================
-
-    // ====================================================================
-    // OPTIMIZATION 7: HISTORY GRAVITY DECAY (+15-25 Elo component)
-    // ====================================================================
-    HistoryGravity::decay_history(mainHistory, nodes);
-
-    // ====================================================================
-    // OPTIMIZATION 8: QUIESCENCE ENHANCEMENTS (+8-15 Elo)
-    // ====================================================================
-    // (Integrated in qsearch_v3() - see below)
-
-    // ====================================================================
-    // OPTIMIZATION 9: NULL MOVE VERIFICATION (+8-15 Elo)
-    // ====================================================================
-    // (Already in v2.0 null move search section - ensure enabled)
-
-    // ========================================================================
-    // PHASE 3 OPTIMIZATIONS INTEGRATION
-    // ========================================================================
-
-    // ====================================================================
-    // OPTIMIZATION 11: MULTI-PROBCUT (+10-15 Elo)
-    // ====================================================================
-    // (Applied before moves loop - see below)
-
-    // ====================================================================
-    // OPTIMIZATION 12: SINGULAR EXTENSION++ (+5-10 Elo)
-    // ====================================================================
-    // (Integrated in singular extension section - see below)
-
-    // ====================================================================
-    // OPTIMIZATION 13: IMPROVED EVAL CACHE (+5-15 Elo)
-    // ====================================================================
-    // (Used in evaluate_v3() - see below)
-
-    // ... [Return bestValue, update TT, etc.] ...
-
-    return bestValue;
-}
-
-
-// ============================================================================
-// V3.0 QUIESCENCE SEARCH
-// ============================================================================
-
-template<NodeType nodeType>
-Value Search::Worker::qsearch_v3(Position& pos, Stack* ss, Value alpha, Value beta) {
-    constexpr bool PvNode = nodeType == PV;
-
-    // ... [Standard qsearch preamble] ...
-
-    // Track check depth to prevent explosions
-    static thread_local int checkDepth = 0;
-
-    // Generate moves
-    MovePicker mp(pos, Move::none(), 0, &mainHistory, /* ... */);
-    Move move;
-    Square lastCaptureSq = (ss-1)->currentMove.to_sq();  // For recapture detection
-
-    while ((move = mp.next_move()) != Move::none()) {
-        // ====================================================================
-        // OPTIMIZATION 8A: CHECK EXTENSION LIMIT (+2-5 Elo)
-        // ====================================================================
-        if (pos.gives_check(move)) {
-            checkDepth++;
-            if (checkDepth > QuiescenceOptimizations::MAX_CHECK_DEPTH) {
-                checkDepth--;
-                continue;  // Don't extend checks too deep
-            }
-        }
-
-        // ====================================================================
-        // OPTIMIZATION 8B: RECAPTURE EXTENSION (+5-8 Elo)
-        // ====================================================================
-        bool isRecapture = QuiescenceOptimizations::is_recapture(
-            lastCaptureSq, move.to_sq()
-        );
+        ss->moveCount = ++moveCount;
 
         do_move(pos, move, st, ss);
 
-        // Extend recaptures (don't reduce depth)
-        Value value;
-        if (isRecapture) {
-            value = -qsearch_v3<nodeType>(pos, ss+1, -beta, -alpha);  // Same depth
-        } else {
-            value = -qsearch_v3<nodeType>(pos, ss+1, -beta, -alpha);  // Normal
-        }
+        Value value = -search<NonPV, SearchBackend::V3>(pos, ss + 1, -beta, -beta + 1,
+                                                        depth - 1 - MultiCutReduction, false);
 
         undo_move(pos, move);
 
-        if (pos.gives_check(move))
-            checkDepth--;
+        if (stopFlag->load(std::memory_order_relaxed))
+            break;
 
-        // ... [Update alpha, best move, etc.] ...
+        if (value >= beta && !is_decisive(value) && ++cutoffs >= MultiCutCutoffs)
+            return beta;
     }
 
-    return alpha;
-}
-
-
-// ============================================================================
-// V3.0 EVALUATION WITH IMPROVED CACHE
-// ============================================================================
-
-Value Search::Worker::evaluate_v3(const Position& pos) {
-    // ====================================================================
-    // OPTIMIZATION 13: 2-WAY ASSOCIATIVE EVAL CACHE (+5-15 Elo)
-    // ====================================================================
-
-    Key posKey = pos.key();
-    Value cachedEval;
-
-    if (g_v3_state.improvedEvalCache.probe(posKey, cachedEval)) {
-        return cachedEval;  // Cache hit!
-    }
-
-    // Cache miss - compute NNUE evaluation
-    Value eval = Eval::NNUE::evaluate(pos, refreshTable[numaAccessToken]);
-
-    // Store in cache with depth
-    g_v3_state.improvedEvalCache.store(posKey, eval, ss->ply);
-
-    return eval;
-}
-
-
-// ============================================================================
-// V3.0 MULTI-PROBCUT (BEFORE MOVES LOOP)
-// ============================================================================
-
-template<NodeType nodeType>
-bool try_multiprobcut_v3(Position& pos, Stack* ss, Value& beta, Depth depth,
-                        Move ttMove, const CapturePieceToHistory& captureHistory) {
-
-    if (depth < 3 || is_decisive(beta))
-        return false;
-
-    // Try both ProbCut levels
-    for (const auto& level : MultiProbCut::LEVELS) {
-        if (depth < level.depthReduction)
-            continue;
-
-        Value probCutBeta = beta + level.betaMargin;
-        Depth probCutDepth = depth - level.depthReduction;
-
-        MovePicker mp(pos, ttMove, probCutBeta - ss->staticEval, &captureHistory);
-        Move move;
-
-        while ((move = mp.next_move()) != Move::none()) {
-            if (!pos.legal(move))
-                continue;
-
-            do_move(pos, move, st, ss);
-
-            Value value = -qsearch<NonPV>(pos, ss+1, -probCutBeta, -probCutBeta+1);
-
-            if (value >= probCutBeta && probCutDepth > 0) {
-                value = -search_v3<NonPV>(pos, ss+1, -probCutBeta, -probCutBeta+1,
-                                         probCutDepth, !cutNode);
-            }
-
-            undo_move(pos, move);
-
-            if (value >= probCutBeta) {
-                // ProbCut success!
-                beta = value;
-                return true;
-            }
-        }
-    }
-
-    return false;
-}
-
-
-// ============================================================================
-// V3.0 ASPIRATION WINDOWS (IN ITERATIVE DEEPENING)
-// ============================================================================
-
-void Search::Worker::iterative_deepening_v3() {
-    // ... [Standard ID preamble] ...
-
-    Value alpha, beta, delta;
-    bool failedHigh = false, failedLow = false;
-    bool lowOnTime = false;  // Track if we're running out of time
-
-    for (Depth depth = 1; depth <= MAX_DEPTH; ++depth) {
-        // ====================================================================
-        // OPTIMIZATION 4: ASPIRATION WINDOW ENHANCEMENTS (+5-10 Elo)
-        // ====================================================================
-
-        // Initial delta
-        delta = 10 + previousScore * previousScore / 15600;
-
-        // Adjust delta based on fail conditions
-        if (failedHigh || failedLow) {
-            delta = AspirationWindowOptimizer::adjust_delta(
-                delta, failedHigh, rootNode, lowOnTime
-            );
-        }
-
-        // Asymmetric windows
-        alpha = std::max(previousScore - delta, -VALUE_INFINITE);
-        beta = std::min(previousScore + delta, VALUE_INFINITE);
-
-        // Search with aspiration window
-        Value value = search_v3<Root>(rootPos, rootStack, alpha, beta, depth, false);
-
-        // Handle fails
-        if (value <= alpha) {
-            failedLow = true;
-            failedHigh = false;
-            beta = (alpha + beta) / 2;
-            alpha = std::max(value - delta, -VALUE_INFINITE);
-        } else if (value >= beta) {
-            failedHigh = true;
-            failedLow = false;
-            beta = std::min(value + delta, VALUE_INFINITE);
-        } else {
-            failedHigh = failedLow = false;
-        }
-
-        // ... [Update previousScore, etc.] ...
-    }
-}
-
-
-// ============================================================================
-// V4.0 SEARCH INTEGRATION (WITH ML)
-// ============================================================================
-
-extern thread_local CapablancaV4State g_v4_state;
-
-template<NodeType nodeType>
-Value Search::Worker::search_v4(Position& pos, Stack* ss, Value alpha, Value beta,
-                                Depth depth, bool cutNode) {
-
-    // All v3.0 optimizations PLUS:
-
-    // ====================================================================
-    // OPTIMIZATION 15: NEURAL MOVE ORDERING (+40-60 Elo)
-    // ====================================================================
-
-    if (g_v4_state.v4_enabled && g_v4_state.policyNet.loaded) {
-        // Extract NNUE features for current position
-        float posFeatures[PolicyNetwork::INPUT_SIZE];
-        PolicyNetwork::extract_features(networks[numaAccessToken], pos, posFeatures);
-
-        // Augment move ordering with policy network scores
-        MovePicker mp_v4(/* ... */);
-        Move move;
-
-        while ((move = mp_v4.next_move()) != Move::none()) {
-            // Check policy cache
-            float policyScore;
-            if (!g_v4_state.policyCache.probe(pos.key(), move, policyScore)) {
-                // Compute policy score
-                policyScore = g_v4_state.policyNet.evaluate_move(posFeatures, move);
-                g_v4_state.policyCache.store(pos.key(), move, policyScore);
-            }
-
-            // Combine with history score
-            int historyScore = /* ... get from history tables ... */;
-            int combinedScore = HybridMoveOrdering::combined_score(
-                policyScore, historyScore
-            );
-
-            // Use combinedScore for move ordering
-            // ... [rest of search] ...
-        }
-    }
-
-    // ====================================================================
-    // OPTIMIZATION 14: LAZY SMP - RMO (+3-5 Elo)
-    // ====================================================================
-
-    // Apply random perturbation to move scores per thread
-    int moveScore = /* ... computed move score ... */;
-    moveScore += RandomizedMoveOrder::perturbation(threadIdx, moveScore);
-
-    // ... [Continue with search_v3 logic] ...
-
-    return search_v3<nodeType>(pos, ss, alpha, beta, depth, cutNode);
-}
-
-
-// ============================================================================
-// V4.0 EVALUATION WITH MULTI-NET NNUE
-// ============================================================================
-
-Value Search::Worker::evaluate_v4(const Position& pos) {
-    if (!g_v4_state.v4_enabled || !g_v4_state.multiNet.loaded[0])
-        return evaluate_v3(pos);  // Fallback to v3.0
-
-    // ====================================================================
-    // OPTIMIZATION 16: MULTI-NET NNUE (+50-80 Elo)
-    // ====================================================================
-
-    GamePhase phase = detect_game_phase(pos);
-    int moveCount = pos.game_ply();
-
-    // Check if we're in a blend zone
-    if (BlendedEvaluation::in_blend_zone(moveCount, phase)) {
-        // Blended evaluation
-        NetworkType net1 = MultiNetNNUE::select_network(phase);
-        NetworkType net2 = (phase == OPENING) ? NET_MIDDLEGAME : NET_OPENING;
-
-        Value eval1 = g_v4_state.multiNet.networks[net1]->evaluate(pos);
-        Value eval2 = g_v4_state.multiNet.networks[net2]->evaluate(pos);
-
-        float weight = BlendedEvaluation::blend_weight(moveCount, phase);
-        return BlendedEvaluation::blend(eval1, eval2, weight);
-    } else {
-        // Single network evaluation
-        return g_v4_state.multiNet.evaluate(pos, phase);
-    }
+    return -VALUE_INFINITE;
 }
 
-} // namespace Stockfish
+}  // namespace Stockfish
@@ -162,11 +162,18 @@ class SharedMemory: public detail::SharedMemoryBase {
     T*                 data_ptr_   = nullptr;
     detail::ShmHeader* header_ptr_ = nullptr;
     size_t             total_size_ = 0;
+    size_t             count_      = 1;
     std::string        sentinel_base_;
     std::string        sentinel_path_;
 
-    static constexpr size_t calculate_total_size() noexcept {
-        return sizeof(T) + sizeof(detail::ShmHeader);
+    // The header follows the data, aligned for its mutex and atomics
+    static constexpr size_t header_offset(size_t count) noexcept {
+        constexpr size_t align = alignof(detail::ShmHeader);
+        return (sizeof(T) * count + align - 1) / align * align;
+    }
+
+    static constexpr size_t calculate_total_size(size_t count) noexcept {
+        return header_offset(count) + sizeof(detail::ShmHeader);
     }
 
     static std::string make_sentinel_base(const std::string& name) {
@@ -177,9 +184,12 @@ class SharedMemory: public detail::SharedMemoryBase {
     }
 
    public:
-    explicit SharedMemory(const std::string& name) noexcept :
+    // A region may also hold an array of `count` objects, e.g. a table that is
+    // written to by all the processes sharing it.
+    explicit SharedMemory(const std::string& name, size_t count = 1) noexcept :
         name_(name),
-        total_size_(calculate_total_size()),
+        total_size_(calculate_total_size(count)),
+        count_(count),
         sentinel_base_(make_sentinel_base(name)) {}
 
     ~SharedMemory() noexcept override {
@@ -197,6 +207,7 @@ class SharedMemory: public detail::SharedMemoryBase {
         data_ptr_(other.data_ptr_),
         header_ptr_(other.header_ptr_),
         total_size_(other.total_size_),
+        count_(other.count_),
         sentinel_base_(std::move(other.sentinel_base_)),
         sentinel_path_(std::move(other.sentinel_path_)) {
 
@@ -217,6 +228,7 @@ class SharedMemory: public detail::SharedMemoryBase {
             data_ptr_      = other.data_ptr_;
             header_ptr_    = other.header_ptr_;
             total_size_    = other.total_size_;
+            count_         = other.count_;
             sentinel_base_ = std::move(other.sentinel_base_);
             sentinel_path_ = std::move(other.sentinel_path_);
 
@@ -228,7 +240,82 @@ class SharedMemory: public detail::SharedMemoryBase {
         return *this;
     }
 
-    [[nodiscard]] bool open(const T& initial_value) noexcept {
+    [[nodiscard]] bool open(const T& initial_value) noexcept { return open_region(&initial_value); }
+
+    // Opens the region without constructing its contents. A newly created
+    // region is zero-filled by the kernel.
+    [[nodiscard]] bool open() noexcept { return open_region(nullptr); }
+
+    void close() noexcept override {
+        if (fd_ == -1 && mapped_ptr_ == nullptr)
+            return;
+
+        bool remove_region = false;
+        bool file_locked   = lock_file(LOCK_EX);
+        bool mutex_locked  = false;
+
+        if (file_locked && header_ptr_ != nullptr)
+            mutex_locked = lock_shared_mutex();
+
+        if (mutex_locked)
+        {
+            if (header_ptr_)
+            {
+                header_ptr_->ref_count.fetch_sub(1, std::memory_order_acq_rel);
+            }
+            remove_sentinel_file();
+            remove_region = !has_other_live_sentinels_locked();
+            unlock_shared_mutex();
+        }
+        else
+        {
+            remove_sentinel_file();
+            decrement_refcount_relaxed();
+        }
+
+        unmap_region();
+
+        if (remove_region)
+            shm_unlink(name_.c_str());
+
+        if (file_locked)
+            unlock_file();
+
+        if (fd_ != -1)
+        {
+            ::close(fd_);
+            fd_ = -1;
+        }
+
+        reset();
+    }
+
+    const std::string& name() const noexcept override { return name_; }
+
+    [[nodiscard]] bool is_open() const noexcept { return fd_ != -1 && mapped_ptr_ && data_ptr_; }
+
+    [[nodiscard]] const T& get() const noexcept { return *data_ptr_; }
+
+    [[nodiscard]] T* data() noexcept { return data_ptr_; }
+
+    [[nodiscard]] size_t count() const noexcept { return count_; }
+
+    [[nodiscard]] const T* operator->() const noexcept { return data_ptr_; }
+
+    [[nodiscard]] const T& operator*() const noexcept { return *data_ptr_; }
+
+    [[nodiscard]] uint32_t ref_count() const noexcept {
+        return header_ptr_ ? header_ptr_->ref_count.load(std::memory_order_acquire) : 0;
+    }
+
+    [[nodiscard]] bool is_initialized() const noexcept {
+        return header_ptr_ ? header_ptr_->initialized.load(std::memory_order_acquire) : false;
+    }
+
+    static void cleanup_all_instances() noexcept { detail::SharedMemoryRegistry::cleanup_all(); }
+
+   private:
+    [[nodiscard]] bool open_region(const T* initial_value) noexcept {
         detail::CleanupHooks::ensure_registered();
 
         bool retried_stale = false;
@@ -318,71 +405,6 @@ class SharedMemory: public detail::SharedMemoryBase {
         }
     }
 
-    void close() noexcept override {
-        if (fd_ == -1 && mapped_ptr_ == nullptr)
-            return;
-
-        bool remove_region = false;
-        bool file_locked   = lock_file(LOCK_EX);
-        bool mutex_locked  = false;
-
-        if (file_locked && header_ptr_ != nullptr)
-            mutex_locked = lock_shared_mutex();
-
-        if (mutex_locked)
-        {
-            if (header_ptr_)
-            {
-                header_ptr_->ref_count.fetch_sub(1, std::memory_order_acq_rel);
-            }
-            remove_sentinel_file();
-            remove_region = !has_other_live_sentinels_locked();
-            unlock_shared_mutex();
-        }
-        else
-        {
-            remove_sentinel_file();
-            decrement_refcount_relaxed();
-        }
-
-        unmap_region();
-
-        if (remove_region)
-            shm_unlink(name_.c_str());
-
-        if (file_locked)
-            unlock_file();
-
-        if (fd_ != -1)
-        {
-            ::close(fd_);
-            fd_ = -1;
-        }
-
-        reset();
-    }
-
-    const std::string& name() const noexcept override { return name_; }
-
-    [[nodiscard]] bool is_open() const noexcept { return fd_ != -1 && mapped_ptr_ && data_ptr_; }
-
-    [[nodiscard]] const T& get() const noexcept { return *data_ptr_; }
-
-    [[nodiscard]] const T* operator->() const noexcept { return data_ptr_; }
-
-    [[nodiscard]] const T& operator*() const noexcept { return *data_ptr_; }
-
-    [[nodiscard]] uint32_t ref_count() const noexcept {
-        return header_ptr_ ? header_ptr_->ref_count.load(std::memory_order_acquire) : 0;
-    }
-
-    [[nodiscard]] bool is_initialized() const noexcept {
-        return header_ptr_ ? header_ptr_->initialized.load(std::memory_order_acquire) : false;
-    }
-
-    static void cleanup_all_instances() noexcept { detail::SharedMemoryRegistry::cleanup_all(); }
-
-   private:
     void reset() noexcept {
         fd_         = -1;
         mapped_ptr_ = nullptr;
@@ -391,6 +413,14 @@ class SharedMemory: public detail::SharedMemoryBase {
         sentinel_path_.clear();
     }
 
+    // Large arrays benefit from huge pages, if shared memory may use them at all
+    void advise_huge_pages() noexcept {
+#if defined(MADV_HUGEPAGE)
+        if (count_ > 1)
+            madvise(mapped_ptr_, total_size_, MADV_HUGEPAGE);
+#endif
+    }
+
     void unmap_region() noexcept {
         if (mapped_ptr_)
         {
@@ -581,7 +611,7 @@ class SharedMemory: public detail::SharedMemoryBase {
         return found;
     }
 
-    [[nodiscard]] bool setup_new_region(const T& initial_value) noexcept {
+    [[nodiscard]] bool setup_new_region(const T* initial_value) noexcept {
         if (ftruncate(fd_, static_cast<off_t>(total_size_)) == -1)
             return false;
 
@@ -595,12 +625,15 @@ class SharedMemory: public detail::SharedMemoryBase {
             return false;
         }
 
-        data_ptr_ = static_cast<T*>(mapped_ptr_);
-        header_ptr_ =
-          reinterpret_cast<detail::ShmHeader*>(static_cast<char*>(mapped_ptr_) + sizeof(T));
+        advise_huge_pages();
+
+        data_ptr_   = static_cast<T*>(mapped_ptr_);
+        header_ptr_ = reinterpret_cast<detail::ShmHeader*>(static_cast<char*>(mapped_ptr_)
+                                                           + header_offset(count_));
 
         new (header_ptr_) detail::ShmHeader{};
-        new (data_ptr_) T{initial_value};
+        if (initial_value)
+            new (data_ptr_) T{*initial_value};
 
         if (!initialize_shared_mutex())
             return false;
@@ -628,9 +661,11 @@ class SharedMemory: public detail::SharedMemoryBase {
             return false;
         }
 
+        advise_huge_pages();
+
         data_ptr_   = static_cast<T*>(mapped_ptr_);
-        header_ptr_ = std::launder(
-          reinterpret_cast<detail::ShmHeader*>(static_cast<char*>(mapped_ptr_) + sizeof(T)));
+        header_ptr_ = std::launder(reinterpret_cast<detail::ShmHeader*>(
+          static_cast<char*>(mapped_ptr_) + header_offset(count_)));
 
         if (!header_ptr_->initialized.load(std::memory_order_acquire)
             || header_ptr_->magic != detail::ShmHeader::SHM_MAGIC)
@@ -653,6 +688,15 @@ template<typename T>
     return std::nullopt;
 }
 
+template<typename T>
+[[nodiscard]] std::optional<SharedMemory<T>> create_shared_array(const std::string& name,
+                                                                 size_t count) noexcept {
+    SharedMemory<T> shm(name, count);
+    if (shm.open())
+        return shm;
+    return std::nullopt;
+}
+
 }  // namespace Stockfish::shm
 
 #endif  // #ifndef SHM_LINUX_H_INCLUDED
@@ -92,6 +92,13 @@ void Thread::wait_for_search_finished() {
     cv.wait(lk, [&] { return !searching; });
 }
 
+// Whether the thread is running a search or a job, without waiting for it
+bool Thread::is_searching() {
+
+    std::lock_guard<std::mutex> lk(mutex);
+    return searching;
+}
+
 // Launching a function in the thread
 void Thread::run_custom_job(std::function<void()> f) {
     {
@@ -132,14 +139,50 @@ void Thread::idle_loop() {
 Search::SearchManager* ThreadPool::main_manager() { return main_thread()->worker->main_manager(); }
 
 uint64_t ThreadPool::nodes_searched() const { return accumulate(&Search::Worker::nodes); }
+// The nodes published by the threads, and the ones of the main thread not yet
+// published. It is exact with one thread, and lower by less than PublishPeriod
+// nodes per other thread. Only to be called by the main thread.
+uint64_t ThreadPool::nodes_searched_approx() const {
+
+    const Search::Worker& main = *main_thread()->worker;
+
+    uint64_t sum = main.nodes.load(std::memory_order_relaxed) - main.nodesPublished;
+    for (auto& published : publishedNodes)
+        sum += published.nodes.load(std::memory_order_relaxed);
+    return sum;
+}
+
 uint64_t ThreadPool::tb_hits() const { return accumulate(&Search::Worker::tbHits); }
+uint64_t ThreadPool::tt_local_probes() const { return accumulate(&Search::Worker::ttLocalProbes); }
+uint64_t ThreadPool::tt_remote_probes() const {
+    return accumulate(&Search::Worker::ttRemoteProbes);
+}
+
+EvalCache::Stats ThreadPool::eval_cache_stats() const {
+    EvalCache::Stats sum;
+
+    for (auto&& th : threads)
+        sum += th->worker->evalCache.get_stats();
+
+    return sum;
+}
+
+TTStats ThreadPool::tt_stats() const {
+    TTStats sum;
+
+    for (auto&& th : threads)
+        sum += th->worker->ttStats;
+
+    return sum;
+}
 
 // Creates/destroys threads to match the requested number.
 // Created and launched threads will immediately go to sleep in idle_loop.
 // Upon resizing, threads are recreated to allow for binding if necessary.
 void ThreadPool::set(const NumaConfig&                           numaConfig,
                      Search::SharedState                         sharedState,
-                     const Search::SearchManager::UpdateContext& updateContext) {
+                     const Search::SearchManager::UpdateContext& updateContext,
+                     size_t                                      maxThreads) {
 
     if (threads.size() > 0)  // destroy any existing thread(s)
     {
@@ -150,7 +193,9 @@ void ThreadPool::set(const NumaConfig&                           numaConfig,
         boundThreadToNumaNode.clear();
     }
 
-    const size_t requested = sharedState.options["Threads"];
+    size_t requested = sharedState.options["Threads"];
+    if (maxThreads)
+        requested = std::min(requested, maxThreads);
 
     if (requested > 0)  // create new thread(s)
     {
@@ -176,6 +221,12 @@ void ThreadPool::set(const NumaConfig&                           numaConfig,
                                 ? numaConfig.distribute_threads_among_numa_nodes(requested)
                                 : std::vector<NumaIndex>{};
 
+        publishedNodes = std::vector<Search::PublishedNodes>(
+          doBindThreads ? *std::max_element(boundThreadToNumaNode.begin(),
+                                            boundThreadToNumaNode.end())
+                            + 1
+                        : 1);
+
         while (threads.size() < requested)
         {
             const size_t    threadId = threads.size();
@@ -274,6 +325,9 @@ void ThreadPool::start_thinking(const OptionsMap&  options,
     if (states.get())
         setupStates = std::move(states);  // Ownership transfer, states is now empty
 
+    for (auto& published : publishedNodes)
+        published.nodes = 0;
+
     // We use Position::set() to set root position across threads. But there are
     // some StateInfo fields (previous, pliesFromNull, capturedPiece) that cannot
     // be deduced from a fen string, so set() clears them and they are set from
@@ -282,9 +336,22 @@ void ThreadPool::start_thinking(const OptionsMap&  options,
     for (auto&& th : threads)
     {
         th->run_custom_job([&]() {
+            const size_t idx = th->worker->threadIdx;
+
             th->worker->limits = limits;
             th->worker->nodes = th->worker->tbHits = th->worker->nmpMinPly =
               th->worker->bestMoveChanges          = 0;
+            th->worker->publishedNodes =
+              &publishedNodes[boundThreadToNumaNode.empty() ? 0 : boundThreadToNumaNode[idx]];
+            th->worker->nodesPublished = 0;
+            th->worker->ttLocalProbes = th->worker->ttRemoteProbes = 0;
+            th->worker->ttStats                                 = {};
+            th->worker->collectTTStats                          = options["HashStats"];
+            th->worker->prefetchWeights                         = options["PrefetchWeights"];
+            th->worker->backend = options["SearchBackend"] == "v3" ? Search::SearchBackend::V3
+                                                                   : Search::SearchBackend::Classic;
+            th->worker->evalCache.resize(options["EvalCache"]);
+            th->worker->evalCache.reset_stats();
             th->worker->rootDepth = th->worker->completedDepth = 0;
             th->worker->rootMoves                              = rootMoves;
             th->worker->rootPos.set(pos.fen(), pos.is_chess960(), &th->worker->rootState);
@@ -299,6 +366,72 @@ void ThreadPool::start_thinking(const OptionsMap&  options,
     main_thread()->start_searching();
 }
 
+// Searches the positions concurrently for a batch analysis. Each thread takes the
+// next position when it is done with the previous one, and searches it alone
+// to the depth or nodes limit, sharing only the TT with the other threads.
+// onResult is called by the thread that searched the position, as soon as it is
+// done, so the results come in the order the searches finish.
+void ThreadPool::analyze(
+  const OptionsMap&                                                 options,
+  const std::vector<std::string>&                                   fens,
+  bool                                                              isChess960,
+  const Search::LimitsType&                                         limits,
+  const std::function<void(size_t, const Search::AnalysisResult&)>& onResult) {
+
+    main_thread()->wait_for_search_finished();
+
+    stop = abortedSearch = false;
+    increaseDepth        = true;
+
+    std::atomic<size_t> nextFen{0};
+
+    for (auto&& th : threads)
+    {
+        th->run_custom_job([&]() {
+            Search::Worker& worker = *th->worker;
+
+            worker.ttStats         = {};
+            worker.collectTTStats  = options["HashStats"];
+            worker.prefetchWeights = options["PrefetchWeights"];
+            worker.backend = options["SearchBackend"] == "v3" ? Search::SearchBackend::V3
+                                                              : Search::SearchBackend::Classic;
+            worker.evalCache.resize(options["EvalCache"]);
+            worker.evalCache.reset_stats();
+
+            for (size_t i; (i = nextFen.fetch_add(1, std::memory_order_relaxed)) < fens.size();)
+                onResult(i, worker.analyze(fens[i], isChess960, limits));
+        });
+    }
+
+    for (auto&& th : threads)
+        th->wait_for_search_finished();
+}
+
+// Evaluates the positions on all the threads, each one taking the next position
+// not yet evaluated. The values are stored in the order of the positions.
+void ThreadPool::evaluate(const std::vector<std::string>& fens,
+                          bool                            isChess960,
+                          Eval::NetSelection              net,
+                          std::vector<Value>&             values) {
+
+    main_thread()->wait_for_search_finished();
+
+    values.resize(fens.size());
+
+    std::atomic<size_t> nextFen{0};
+
+    for (auto&& th : threads)
+    {
+        th->run_custom_job([&]() {
+            for (size_t i; (i = nextFen.fetch_add(1, std::memory_order_relaxed)) < fens.size();)
+                values[i] = th->worker->static_eval(fens[i], isChess960, net);
+        });
+    }
+
+    for (auto&& th : threads)
+        th->wait_for_search_finished();
+}
+
 Thread* ThreadPool::get_best_thread() const {
 
     Thread* bestThread = threads.front().get();
@@ -384,6 +517,9 @@ void ThreadPool::wait_for_search_finished() const {
             th->wait_for_search_finished();
 }
 
+// The main thread finishes its search after the other threads
+bool ThreadPool::search_running() const { return main_thread()->is_searching(); }
+
 std::vector<size_t> ThreadPool::get_bound_thread_count_by_numa_node() const {
     std::vector<size_t> counts;
 
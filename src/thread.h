@@ -23,6 +23,7 @@
 #include <condition_variable>
 #include <cstddef>
 #include <cstdint>
+#include <deque>
 #include <functional>
 #include <memory>
 #include <mutex>
@@ -92,6 +93,7 @@ class Thread {
     // appropriate specificity regarding search, from the point of view of an
     // outside user, so renaming of this function is left for whenever that happens.
     void   wait_for_search_finished();
+    bool   is_searching();
     size_t id() const { return idx; }
 
     LargePagePtr<Search::Worker> worker;
@@ -131,24 +133,50 @@ class ThreadPool {
     ThreadPool& operator=(ThreadPool&&)      = delete;
 
     void   start_thinking(const OptionsMap&, Position&, StateListPtr&, Search::LimitsType);
+    void   analyze(const OptionsMap&,
+                   const std::vector<std::string>& fens,
+                   bool                            isChess960,
+                   const Search::LimitsType&,
+                   const std::function<void(size_t, const Search::AnalysisResult&)>& onResult);
+    void   evaluate(const std::vector<std::string>& fens,
+                    bool                            isChess960,
+                    Eval::NetSelection              net,
+                    std::vector<Value>&             values);
     void   run_on_thread(size_t threadId, std::function<void()> f);
     void   wait_on_thread(size_t threadId);
     size_t num_threads() const;
     void   clear();
-    void   set(const NumaConfig& numaConfig,
-               Search::SharedState,
-               const Search::SearchManager::UpdateContext&);
+
+    // The states of the position of the last search, which the engine extends
+    // in place once that search has finished, instead of setting it up again
+    std::deque<StateInfo>& setup_states() { return *setupStates; }
+    bool                   search_running() const;
+
+    // Creates the threads of the Threads option, at most maxThreads of them
+    // unless it is 0
+    void set(const NumaConfig& numaConfig,
+             Search::SharedState,
+             const Search::SearchManager::UpdateContext&,
+             size_t maxThreads = 0);
 
     Search::SearchManager* main_manager();
     Thread*                main_thread() const { return threads.front().get(); }
     uint64_t               nodes_searched() const;
+    uint64_t               nodes_searched_approx() const;
     uint64_t               tb_hits() const;
+    uint64_t               tt_local_probes() const;
+    uint64_t               tt_remote_probes() const;
+    TTStats                tt_stats() const;
+    EvalCache::Stats       eval_cache_stats() const;
     Thread*                get_best_thread() const;
     void                   start_searching();
     void                   wait_for_search_finished() const;
 
     std::vector<size_t> get_bound_thread_count_by_numa_node() const;
 
+    // The NUMA node of each thread, empty if the threads are not bound
+    const std::vector<NumaIndex>& get_bound_numa_nodes() const { return boundThreadToNumaNode; }
+
     void ensure_network_replicated();
 
     std::atomic_bool stop, abortedSearch, increaseDepth;
@@ -164,6 +192,7 @@ class ThreadPool {
     StateListPtr                         setupStates;
     std::vector<std::unique_ptr<Thread>> threads;
     std::vector<NumaIndex>               boundThreadToNumaNode;
+    std::vector<Search::PublishedNodes>  publishedNodes;  // Indexed by NUMA node
 
     uint64_t accumulate(std::atomic<uint64_t> Search::Worker::* member) const {
 
@@ -20,14 +20,41 @@
 
 #include <algorithm>
 #include <cassert>
+#include <chrono>
 #include <cmath>
 #include <cstdint>
+#include <utility>
 
 #include "search.h"
 #include "ucioption.h"
 
 namespace Stockfish {
 
+void DeadlineTimer::start(TimePoint deadline, std::function<void()> onDeadline) {
+    cancel();
+    cancelled = false;
+
+    const auto timePoint =
+      std::chrono::steady_clock::time_point(std::chrono::milliseconds(deadline));
+
+    thread = std::thread([this, timePoint, f = std::move(onDeadline)]() {
+        std::unique_lock<std::mutex> lk(mutex);
+        if (!cv.wait_until(lk, timePoint, [this] { return cancelled; }))
+            f();
+    });
+}
+
+void DeadlineTimer::cancel() {
+    {
+        std::lock_guard<std::mutex> lk(mutex);
+        cancelled = true;
+    }
+    cv.notify_all();
+
+    if (thread.joinable())
+        thread.join();
+}
+
 TimePoint TimeManagement::optimum() const { return optimumTime; }
 TimePoint TimeManagement::maximum() const { return maximumTime; }
 
@@ -19,7 +19,11 @@
 #ifndef TIMEMAN_H_INCLUDED
 #define TIMEMAN_H_INCLUDED
 
+#include <condition_variable>
 #include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
 
 #include "misc.h"
 
@@ -62,6 +66,24 @@ class TimeManagement {
     bool         useNodesTime   = false;  // True if we are in 'nodes as time' mode
 };
 
+// Calls a function at a deadline from a thread of its own, unless cancelled
+// before. The search uses it to stop exactly at the time limit, instead of at
+// the first time check of the main thread after the limit.
+class DeadlineTimer {
+   public:
+    ~DeadlineTimer() { cancel(); }
+
+    // The deadline is a time point as returned by now()
+    void start(TimePoint deadline, std::function<void()> onDeadline);
+    void cancel();
+
+   private:
+    std::thread             thread;
+    std::mutex              mutex;
+    std::condition_variable cv;
+    bool                    cancelled = false;
+};
+
 }  // namespace Stockfish
 
 #endif  // #ifndef TIMEMAN_H_INCLUDED
@@ -18,23 +18,34 @@
 
 #include "tt.h"
 
+#include <algorithm>
 #include <cassert>
+#include <cmath>
 #include <cstdint>
 #include <cstdlib>
 #include <cstring>
+#include <fstream>
+#include <functional>
 #include <iostream>
+#include <new>
+#include <sstream>
+#include <thread>
+#include <utility>
+#include <vector>
 
 #include "memory.h"
 #include "misc.h"
+#include "numa.h"
+#include "shm.h"
 #include "syzygy/tbprobe.h"
 #include "thread.h"
 
 namespace Stockfish {
 
 
-// TTEntry struct is the 10 bytes transposition table entry, defined as below:
+// TTEntry struct is the transposition table entry, defined as below:
 //
-// key        16 bit
+// key        16 or 32 bit, depending on the format
 // depth       8 bit
 // generation  5 bit
 // pv node     1 bit
@@ -46,6 +57,7 @@ namespace Stockfish {
 // These fields are in the same order as accessed by TT::probe(), since memory is fastest sequentially.
 // Equally, the store order in save() matches this order.
 
+template<typename KeyType>
 struct TTEntry {
 
     // Convert internal bitfields to external types
@@ -56,14 +68,22 @@ struct TTEntry {
     }
 
     bool is_occupied() const;
-    void save(Key k, Value v, bool pv, Bound b, Depth d, Move m, Value ev, uint8_t generation8);
+    void save(Key      k,
+              Value    v,
+              bool     pv,
+              Bound    b,
+              Depth    d,
+              Move     m,
+              Value    ev,
+              uint8_t  generation8,
+              TTStats* stats);
     // The returned age is a multiple of TranspositionTable::GENERATION_DELTA
     uint8_t relative_age(const uint8_t generation8) const;
 
    private:
     friend class TranspositionTable;
 
-    uint16_t key16;
+    KeyType  key;
     uint8_t  depth8;
     uint8_t  genBound8;
     Move     move16;
@@ -86,25 +106,44 @@ static constexpr int GENERATION_MASK = (0xFF << GENERATION_BITS) & 0xFF;
 // DEPTH_ENTRY_OFFSET exists because 1) we use `bool(depth8)` as the occupancy check, but
 // 2) we need to store negative depths for QS. (`depth8` is the only field with "spare bits":
 // we sacrifice the ability to store depths greater than 1<<8 less the offset, as asserted in `save`.)
-bool TTEntry::is_occupied() const { return bool(depth8); }
+template<typename KeyType>
+bool TTEntry<KeyType>::is_occupied() const {
+    return bool(depth8);
+}
 
 // Populates the TTEntry with a new node's data, possibly
 // overwriting an old position. The update is not atomic and can be racy.
-void TTEntry::save(
-  Key k, Value v, bool pv, Bound b, Depth d, Move m, Value ev, uint8_t generation8) {
+template<typename KeyType>
+void TTEntry<KeyType>::save(Key      k,
+                            Value    v,
+                            bool     pv,
+                            Bound    b,
+                            Depth    d,
+                            Move     m,
+                            Value    ev,
+                            uint8_t  generation8,
+                            TTStats* stats) {
 
     // Preserve the old ttmove if we don't have a new one
-    if (m || uint16_t(k) != key16)
+    if (m || KeyType(k) != key)
         move16 = m;
 
     // Overwrite less valuable entries (cheapest checks first)
-    if (b == BOUND_EXACT || uint16_t(k) != key16 || d - DEPTH_ENTRY_OFFSET + 2 * pv > depth8 - 4
+    if (b == BOUND_EXACT || KeyType(k) != key || d - DEPTH_ENTRY_OFFSET + 2 * pv > depth8 - 4
         || relative_age(generation8))
     {
         assert(d > DEPTH_ENTRY_OFFSET);
         assert(d < 256 + DEPTH_ENTRY_OFFSET);
 
-        key16     = uint16_t(k);
+        if (stats)
+        {
+            if (KeyType(k) == key && is_occupied())
+                stats->sameKeyOverwrites++;
+            else if (depth8 > d - DEPTH_ENTRY_OFFSET)
+                stats->deeperReplacements++;
+        }
+
+        key       = KeyType(k);
         depth8    = uint8_t(d - DEPTH_ENTRY_OFFSET);
         genBound8 = uint8_t(generation8 | uint8_t(pv) << 2 | b);
         value16   = int16_t(v);
@@ -115,7 +154,8 @@ void TTEntry::save(
 }
 
 
-uint8_t TTEntry::relative_age(const uint8_t generation8) const {
+template<typename KeyType>
+uint8_t TTEntry<KeyType>::relative_age(const uint8_t generation8) const {
     // Due to our packed storage format for generation and its cyclic
     // nature we add GENERATION_CYCLE (256 is the modulus, plus what
     // is needed to keep the unrelated lowest n bits from affecting
@@ -125,39 +165,224 @@ uint8_t TTEntry::relative_age(const uint8_t generation8) const {
 }
 
 
+// A TranspositionTable is an array of Cluster, of size clusterCount. Each cluster consists of ClusterSize number
+// of TTEntry. Each non-empty TTEntry contains information on exactly one position. The size of a Cluster should
+// divide the size of a cache line for best performance, as the cacheline is prefetched when possible.
+//
+// The entry key width, the number of entries and the size of a cluster are template parameters, so each format
+// gets its own probe() with all of them known at compile time. The format hash identifies the layout in saved
+// tables, so a file written with another layout or by an incompatible build is never reused.
+
+template<typename KeyType, int Size, size_t Bytes>
+struct Cluster {
+    using Entry = TTEntry<KeyType>;
+
+    static constexpr int      ClusterSize = Size;
+    static constexpr uint64_t FormatHash =
+      0x5454464D00000000ULL | sizeof(Entry) << 16 | Bytes << 8 | Size;
+
+    Entry entry[Size];
+    char  padding[Bytes - Size * sizeof(Entry)];
+};
+
+// 3 entries with a 16-bit key in 32 bytes
+using CompactCluster = Cluster<uint16_t, 3, 32>;
+// 5 entries with a 32-bit key in 64 bytes
+using WideCluster = Cluster<uint32_t, 5, 64>;
+
+static_assert(sizeof(CompactCluster) == 32, "Suboptimal Cluster size");
+static_assert(sizeof(WideCluster) == 64, "Suboptimal Cluster size");
+
+static size_t cluster_bytes(TTFormat format) {
+    return format == TTFormat::Wide ? sizeof(WideCluster) : sizeof(CompactCluster);
+}
+
+static uint64_t format_hash(TTFormat format) {
+    return format == TTFormat::Wide ? WideCluster::FormatHash : CompactCluster::FormatHash;
+}
+
+// Granularity of the NUMA placement, matching the huge page size
+static constexpr size_t NumaChunkBytes = 2 * 1024 * 1024;
+
+
 // TTWriter is but a very thin wrapper around the pointer
-TTWriter::TTWriter(TTEntry* tte) :
-    entry(tte) {}
+TTWriter::TTWriter(void* tte, TTFormat f, TTStats* st) :
+    entry(tte),
+    format(f),
+    stats(st) {}
 
 void TTWriter::write(
   Key k, Value v, bool pv, Bound b, Depth d, Move m, Value ev, uint8_t generation8) {
-    entry->save(k, v, pv, b, d, m, ev, generation8);
+    if (stats)
+        stats->writes++;
+
+    if (format == TTFormat::Wide)
+        static_cast<WideCluster::Entry*>(entry)->save(k, v, pv, b, d, m, ev, generation8, stats);
+    else
+        static_cast<CompactCluster::Entry*>(entry)->save(k, v, pv, b, d, m, ev, generation8,
+                                                         stats);
 }
 
 
-// A TranspositionTable is an array of Cluster, of size clusterCount. Each cluster consists of ClusterSize number
-// of TTEntry. Each non-empty TTEntry contains information on exactly one position. The size of a Cluster should
-// divide the size of a cache line for best performance, as the cacheline is prefetched when possible.
+uint64_t TTStats::total_hits() const {
+    uint64_t sum = 0;
+    for (uint64_t h : hits)
+        sum += h;
+    return sum;
+}
+
+TTStats& TTStats::operator+=(const TTStats& other) {
+    probes += other.probes;
+    for (int i = 0; i < DepthBuckets; ++i)
+        hits[i] += other.hits[i];
+    misses += other.misses;
+    aliases += other.aliases;
+    writes += other.writes;
+    sameKeyOverwrites += other.sameKeyOverwrites;
+    deeperReplacements += other.deeperReplacements;
+    return *this;
+}
 
-static constexpr int ClusterSize = 3;
 
-struct Cluster {
-    TTEntry entry[ClusterSize];
-    char    padding[2];  // Pad to 32 bytes
+// A saved or file-backed table starts with this header, padded to a full page so
+// that the clusters following it stay page aligned.
+struct TTFileHeader {
+    uint64_t formatHash;
+    uint64_t clusterCount;
+    uint8_t  generation8;
+};
+
+static constexpr size_t TTFileHeaderSize = 4096;
+
+static TTFileHeader* file_header(void* mappedFile) {
+    return std::launder(reinterpret_cast<TTFileHeader*>(mappedFile));
+}
+
+
+// The named shared memory holding a table that is probed and written to by several
+// processes at once. The SharedMemoryRegistry takes care of removing the region
+// when the last process using it exits, even if it gets killed by a signal.
+#if !defined(_WIN32) && !defined(__ANDROID__)
+
+struct TranspositionTable::SharedRegion {
+    shm::SharedMemory<CompactCluster> memory;
+
+    bool in_use_by_others() const { return memory.ref_count() > 1; }
 };
 
-static_assert(sizeof(Cluster) == 32, "Suboptimal Cluster size");
+#else
+
+struct TranspositionTable::SharedRegion {
+    bool in_use_by_others() const { return false; }
+};
+
+#endif
+
+
+TranspositionTable::TranspositionTable() = default;
+TranspositionTable::~TranspositionTable() { free_table(); }
+
+
+void TranspositionTable::free_table() {
+    if (sharedRegion)
+        sharedRegion.reset();
+    else if (mappedFile)
+        file_mapped_free(mappedFile, mappedSize);
+    else
+        aligned_large_pages_free(table);
+
+    table        = nullptr;
+    mappedFile   = nullptr;
+    mappedSize   = 0;
+    keepContents = false;
+}
 
 
 // Sets the size of the transposition table,
 // measured in megabytes. Transposition table consists
 // of clusters and each cluster consists of ClusterSize number of TTEntry.
-void TranspositionTable::resize(size_t mbSize, ThreadPool& threads) {
-    aligned_large_pages_free(table);
+// The table may live in a file, where the contents left by a previous run are
+// kept as long as their layout and size match, or in shared memory, where it is
+// attached to by every process using the same name, layout and size.
+// A private table keeping its layout gets the entries of the previous one, which
+// requires both tables in memory while they are moved.
+void TranspositionTable::resize(size_t mbSize, ThreadPool& threads, const TTStorage& storage) {
+    const bool keepEntries = table && !mappedFile && !sharedRegion && storage.file.empty()
+                          && storage.sharedName.empty() && storage.format == format;
+    char*         oldTable        = keepEntries ? std::exchange(table, nullptr) : nullptr;
+    const size_t  oldClusterCount = clusterCount;
+    const uint8_t oldGeneration8  = generation8;
+
+    free_table();
+
+    format           = storage.format;
+    formatHash       = format_hash(format);
+    clusterBytes     = cluster_bytes(format);
+    clusterCount     = mbSize * 1024 * 1024 / clusterBytes;
+    clustersPerChunk = NumaChunkBytes / clusterBytes;
+    chunkCount       = (clusterCount + clustersPerChunk - 1) / clustersPerChunk;
+
+    // Pages of a shared or file-backed table may already be in memory somewhere,
+    // so the placement only applies to private memory.
+    numaConfig    = storage.numaConfig;
+    numaNodes     = numaConfig ? numaConfig->num_numa_nodes() : 1;
+    numaPlacement = numaNodes > 1 && storage.sharedName.empty() && storage.file.empty()
+                    ? storage.numaPlacement
+                    : TTNumaPlacement::Auto;
+
+#if !defined(_WIN32) && !defined(__ANDROID__)
+    if (!storage.sharedName.empty())
+    {
+        // Only tables with the same layout and size are shared
+        std::stringstream ss;
+        ss << "/sf_tt_" << std::hex
+           << std::hash<std::string>{}(storage.sharedName + "$" + std::to_string(formatHash) + "$"
+                                       + std::to_string(clusterCount));
+
+        // The region is allocated in units of the smallest cluster
+        const size_t units = clusterCount * clusterBytes / sizeof(CompactCluster);
+
+        if (auto memory = shm::create_shared_array<CompactCluster>(ss.str(), units))
+        {
+            sharedRegion = std::make_unique<SharedRegion>(SharedRegion{std::move(*memory)});
+            table        = reinterpret_cast<char*>(sharedRegion->memory.data());
+
+            // A newly created region is already zeroed
+            return;
+        }
+    }
+#endif
 
-    clusterCount = mbSize * 1024 * 1024 / sizeof(Cluster);
+    if (!storage.file.empty())
+    {
+        mappedSize = TTFileHeaderSize + clusterCount * clusterBytes;
+        mappedFile = file_mapped_alloc(storage.file, mappedSize);
+
+        if (mappedFile)
+        {
+            TTFileHeader* header = file_header(mappedFile);
+            table                = static_cast<char*>(mappedFile) + TTFileHeaderSize;
+
+            if (header->formatHash == formatHash && header->clusterCount == clusterCount)
+            {
+                generation8  = header->generation8;
+                keepContents = true;
+                return;
+            }
+
+            // Invalidate the header first, so an interrupted clear is not trusted later
+            header->formatHash = 0;
+            clear(threads);
+            header->clusterCount = clusterCount;
+            header->formatHash   = formatHash;
+            return;
+        }
+
+        // Fall back to anonymous memory
+        mappedSize = 0;
+    }
 
-    table = static_cast<Cluster*>(aligned_large_pages_alloc(clusterCount * sizeof(Cluster)));
+    table = static_cast<char*>(aligned_large_pages_alloc(clusterCount * clusterBytes));
 
     if (!table)
     {
@@ -166,24 +391,72 @@ void TranspositionTable::resize(size_t mbSize, ThreadPool& threads) {
     }
 
     clear(threads);
+
+    if (oldTable)
+    {
+        generation8 = oldGeneration8;
+
+        if (format == TTFormat::Wide)
+            rehash<WideCluster>(oldTable, oldClusterCount, threads);
+        else
+            rehash<CompactCluster>(oldTable, oldClusterCount, threads);
+
+        aligned_large_pages_free(oldTable);
+    }
 }
 
 
-// Initializes the entire transposition table to zero,
-// in a multi-threaded way.
-void TranspositionTable::clear(ThreadPool& threads) {
-    generation8              = 0;
-    const size_t threadCount = threads.num_threads();
+// Moves the entries of a previous table into the current one, in a multi-threaded way.
+// Clusters are indexed by the upper key bits, so each cluster gathers the entries of
+// the old clusters covering the same range of keys, and keeps the most valuable ones
+// according to the replacement strategy. Only the lower key bits are stored, so when
+// growing, an entry is copied to every cluster its position may now belong to. The
+// copies that landed in the wrong cluster are never hit and just age out.
+template<typename ClusterType>
+void TranspositionTable::rehash(const char* oldTable, size_t oldClusterCount, ThreadPool& threads) {
+
+    using Entry     = typename ClusterType::Entry;
+    constexpr int N = ClusterType::ClusterSize;
+
+    const ClusterType* oldClusters = reinterpret_cast<const ClusterType*>(oldTable);
+    ClusterType*       newClusters = reinterpret_cast<ClusterType*>(table);
+    const double       ratio       = double(oldClusterCount) / clusterCount;
+    const size_t       threadCount = threads.num_threads();
+
+    auto value = [this](const Entry& e) { return e.depth8 - e.relative_age(generation8); };
 
     for (size_t i = 0; i < threadCount; ++i)
     {
-        threads.run_on_thread(i, [this, i, threadCount]() {
-            // Each thread will zero its part of the hash table
+        threads.run_on_thread(i, [=, &value]() {
+            // Each thread will fill its part of the hash table
             const size_t stride = clusterCount / threadCount;
             const size_t start  = stride * i;
-            const size_t len    = i + 1 != threadCount ? stride : clusterCount - start;
-
-            std::memset(&table[start], 0, len * sizeof(Cluster));
+            const size_t end    = i + 1 != threadCount ? start + stride : clusterCount;
+
+            for (size_t c = start; c < end; ++c)
+            {
+                const size_t first = size_t(c * ratio);
+                const size_t last =
+                  std::min(size_t(std::ceil((c + 1) * ratio)), oldClusterCount);
+
+                // The kept entries are sorted by decreasing value
+                Entry* kept = newClusters[c].entry;
+                int    n    = 0;
+
+                for (size_t o = first; o < last; ++o)
+                    for (const Entry& e : oldClusters[o].entry)
+                    {
+                        if (!e.is_occupied() || (n == N && value(e) <= value(kept[N - 1])))
+                            continue;
+
+                        int j = std::min(n, N - 1);
+                        for (; j > 0 && value(kept[j - 1]) < value(e); --j)
+                            kept[j] = kept[j - 1];
+
+                        kept[j] = e;
+                        n       = std::min(n + 1, N);
+                    }
+            }
         });
     }
 
@@ -192,24 +465,185 @@ void TranspositionTable::clear(ThreadPool& threads) {
 }
 
 
+// Initializes the entire transposition table to zero,
+// in a multi-threaded way. A table shared with other running
+// processes is left to them, its entries just age out.
+// Private memory is just handed back to the system when possible, so that
+// clearing takes no time whatever the size, the pages being zeroed by the
+// system as the next searches touch them. This would undo the placement on
+// the NUMA nodes, made by the threads zeroing it.
+void TranspositionTable::clear(ThreadPool& threads) {
+    keepContents = false;
+
+    if (sharedRegion && sharedRegion->in_use_by_others())
+        return;
+
+    generation8              = 0;
+    const size_t threadCount = threads.num_threads();
+
+    if (is_numa_placed())
+        clear_numa_placed(threads);
+    else if (mappedFile || sharedRegion || !discard_large_pages(table, clusterCount * clusterBytes))
+    {
+        for (size_t i = 0; i < threadCount; ++i)
+        {
+            threads.run_on_thread(i, [this, i, threadCount]() {
+                // Each thread will zero its part of the hash table
+                const size_t stride = clusterCount / threadCount;
+                const size_t start  = stride * i;
+                const size_t len    = i + 1 != threadCount ? stride : clusterCount - start;
+
+                std::memset(&table[start * clusterBytes], 0, len * clusterBytes);
+            });
+        }
+
+        for (size_t i = 0; i < threadCount; ++i)
+            threads.wait_on_thread(i);
+    }
+
+    if (mappedFile)
+        file_header(mappedFile)->generation8 = generation8;
+}
+
+
+// Zeroes every chunk from a thread running on the NUMA node the chunk belongs to,
+// so that its pages get allocated there. The search threads do it if each node
+// has some bound to it, otherwise one thread is started per node just for this.
+void TranspositionTable::clear_numa_placed(ThreadPool& threads) {
+    const std::vector<NumaIndex>& boundNodes = threads.get_bound_numa_nodes();
+    std::vector<size_t>           threadsOnNode(numaNodes, 0);
+
+    for (NumaIndex n : boundNodes)
+        if (n < numaNodes)
+            threadsOnNode[n]++;
+
+    // The chunks of node n are shared among the count threads running on it
+    auto clearNode = [this](size_t n, size_t rank, size_t count) {
+        for (size_t c = 0, k = 0; c < chunkCount; ++c)
+            if (chunk_node(c) == n && k++ % count == rank)
+                clear_chunk(c);
+    };
+
+    if (std::find(threadsOnNode.begin(), threadsOnNode.end(), 0) == threadsOnNode.end())
+    {
+        std::vector<size_t> rank(numaNodes, 0);
+
+        for (size_t i = 0; i < boundNodes.size(); ++i)
+        {
+            const size_t n = boundNodes[i], r = rank[n]++, count = threadsOnNode[n];
+            threads.run_on_thread(i, [&clearNode, n, r, count]() { clearNode(n, r, count); });
+        }
+
+        for (size_t i = 0; i < boundNodes.size(); ++i)
+            threads.wait_on_thread(i);
+    }
+    else
+    {
+        std::vector<std::thread> helpers;
+
+        for (size_t n = 0; n < numaNodes; ++n)
+            helpers.emplace_back([this, &clearNode, n]() {
+                numaConfig->bind_current_thread_to_numa_node(n);
+                clearNode(n, 0, 1);
+            });
+
+        for (auto& th : helpers)
+            th.join();
+    }
+}
+
+
+
+void TranspositionTable::clear_chunk(size_t chunk) {
+    const size_t start = chunk * clustersPerChunk;
+    const size_t len   = std::min(clustersPerChunk, clusterCount - start);
+
+    std::memset(&table[start * clusterBytes], 0, len * clusterBytes);
+}
+
+
+size_t TranspositionTable::chunk_node(size_t chunk) const {
+    return numaPlacement == TTNumaPlacement::Interleave ? chunk % numaNodes
+                                                        : chunk * numaNodes / chunkCount;
+}
+
+
+size_t TranspositionTable::numa_node_of(const Key key) const {
+    return chunk_node(mul_hi64(key, clusterCount) / clustersPerChunk);
+}
+
+
+// Writes the table to a file, in the same layout used when the table is backed
+// by a file, so that a saved table can also be used directly as the hash file.
+bool TranspositionTable::save(const std::string& path) const {
+    std::ofstream stream(path, std::ios::binary);
+
+    char         headerPage[TTFileHeaderSize] = {};
+    TTFileHeader header{formatHash, clusterCount, generation8};
+    std::memcpy(headerPage, &header, sizeof(header));
+    stream.write(headerPage, sizeof(headerPage));
+
+    stream.write(table, std::streamsize(clusterCount * clusterBytes));
+
+    return bool(stream);
+}
+
+
+// Reads back a table written by save(). The file must have been saved with
+// the same entry layout and the same hash size as the current table.
+bool TranspositionTable::load(const std::string& path) {
+    std::ifstream stream(path, std::ios::binary);
+
+    char         headerPage[TTFileHeaderSize];
+    TTFileHeader header;
+    if (!stream.read(headerPage, sizeof(headerPage)))
+        return false;
+
+    std::memcpy(&header, headerPage, sizeof(header));
+    if (header.formatHash != formatHash || header.clusterCount != clusterCount)
+        return false;
+
+    if (!stream.read(table, std::streamsize(clusterCount * clusterBytes)))
+        return false;
+
+    generation8  = header.generation8;
+    keepContents = true;
+
+    if (mappedFile)
+        file_header(mappedFile)->generation8 = generation8;
+
+    return true;
+}
+
+
 // Returns an approximation of the hashtable
 // occupation during a search. The hash is x permill full, as per UCI protocol.
 // Only counts entries which match the current generation.
 int TranspositionTable::hashfull(int maxAge) const {
-    int maxAgeInternal = maxAge << GENERATION_BITS;
-    int cnt            = 0;
+    return format == TTFormat::Wide ? hashfull<WideCluster>(maxAge)
+                                    : hashfull<CompactCluster>(maxAge);
+}
+
+template<typename ClusterType>
+int TranspositionTable::hashfull(int maxAge) const {
+    const ClusterType* clusters       = reinterpret_cast<const ClusterType*>(table);
+    int                maxAgeInternal = maxAge << GENERATION_BITS;
+    int                cnt            = 0;
     for (int i = 0; i < 1000; ++i)
-        for (int j = 0; j < ClusterSize; ++j)
-            cnt += table[i].entry[j].is_occupied()
-                && table[i].entry[j].relative_age(generation8) <= maxAgeInternal;
+        for (int j = 0; j < ClusterType::ClusterSize; ++j)
+            cnt += clusters[i].entry[j].is_occupied()
+                && clusters[i].entry[j].relative_age(generation8) <= maxAgeInternal;
 
-    return cnt / ClusterSize;
+    return cnt / ClusterType::ClusterSize;
 }
 
 
 void TranspositionTable::new_search() {
     // increment by delta to keep lower bits as is
     generation8 += GENERATION_DELTA;
+
+    if (mappedFile)
+        file_header(mappedFile)->generation8 = generation8;
 }
 
 
@@ -222,32 +656,71 @@ uint8_t TranspositionTable::generation() const { return generation8; }
 // to be replaced later. The replace value of an entry is calculated as its depth
 // minus 8 times its relative age. TTEntry t1 is considered more valuable than
 // TTEntry t2 if its replace value is greater than that of t2.
-std::tuple<bool, TTData, TTWriter> TranspositionTable::probe(const Key key) const {
+// If stats are given, the probe and the write through the returned writer
+// are counted there.
+std::tuple<bool, TTData, TTWriter> TranspositionTable::probe(const Key      key,
+                                                             TTStats*      stats) const {
+    return format == TTFormat::Wide ? probe<WideCluster>(key, stats)
+                                    : probe<CompactCluster>(key, stats);
+}
 
-    TTEntry* const tte   = first_entry(key);
-    const uint16_t key16 = uint16_t(key);  // Use the low 16 bits as key inside the cluster
+template<typename ClusterType>
+std::tuple<bool, TTData, TTWriter> TranspositionTable::probe(const Key      key,
+                                                             TTStats*      stats) const {
 
-    for (int i = 0; i < ClusterSize; ++i)
-        if (tte[i].key16 == key16)
+    using Entry     = typename ClusterType::Entry;
+    using KeyType   = decltype(Entry::key);
+    constexpr int N = ClusterType::ClusterSize;
+
+    Entry* const  tte    = reinterpret_cast<ClusterType*>(table)[mul_hi64(key, clusterCount)].entry;
+    const KeyType keyLow = KeyType(key);  // Use the low bits as key inside the cluster
+
+    if (stats)
+    {
+        stats->probes++;
+
+        // Entries a 16-bit key would have taken for this position, only the wider
+        // keys can tell them apart. These are the false hits of the compact format.
+        if constexpr (sizeof(KeyType) > sizeof(uint16_t))
+            for (int i = 0; i < N; ++i)
+                stats->aliases += tte[i].key != keyLow && uint16_t(tte[i].key) == uint16_t(key)
+                               && tte[i].is_occupied();
+    }
+
+    for (int i = 0; i < N; ++i)
+        if (tte[i].key == keyLow)
+        {
             // This gap is the main place for read races.
             // After `read()` completes that copy is final, but may be self-inconsistent.
-            return {tte[i].is_occupied(), tte[i].read(), TTWriter(&tte[i])};
+            const TTData data = tte[i].read();
+            const bool   hit  = tte[i].is_occupied();
+
+            if (stats && hit)
+                stats->hits[TTStats::depth_bucket(data.depth)]++;
+            else if (stats)
+                stats->misses++;
+
+            return {hit, data, TTWriter(&tte[i], format, stats)};
+        }
+
+    if (stats)
+        stats->misses++;
 
     // Find an entry to be replaced according to the replacement strategy
-    TTEntry* replace = tte;
-    for (int i = 1; i < ClusterSize; ++i)
+    Entry* replace = tte;
+    for (int i = 1; i < N; ++i)
         if (replace->depth8 - replace->relative_age(generation8)
             > tte[i].depth8 - tte[i].relative_age(generation8))
             replace = &tte[i];
 
     return {false,
             TTData{Move::none(), VALUE_NONE, VALUE_NONE, DEPTH_ENTRY_OFFSET, BOUND_NONE, false},
-            TTWriter(replace)};
+            TTWriter(replace, format, stats)};
 }
 
 
-TTEntry* TranspositionTable::first_entry(const Key key) const {
-    return &table[mul_hi64(key, clusterCount)].entry[0];
+void* TranspositionTable::first_entry(const Key key) const {
+    return &table[mul_hi64(key, clusterCount) * clusterBytes];
 }
 
 }  // namespace Stockfish
@@ -19,18 +19,21 @@
 #ifndef TT_H_INCLUDED
 #define TT_H_INCLUDED
 
+#include <algorithm>
 #include <cstddef>
 #include <cstdint>
+#include <memory>
+#include <string>
 #include <tuple>
+#include <utility>
 
 #include "memory.h"
 #include "types.h"
 
 namespace Stockfish {
 
+class NumaConfig;
 class ThreadPool;
-struct TTEntry;
-struct Cluster;
 
 // There is only one global hash table for the engine and all its threads. For chess in particular, we even allow racy
 // updates between threads to and from the TT, as taking the time to synchronize access would cost thinking time and
@@ -66,6 +69,43 @@ struct TTData {
 };
 
 
+// The layout of the entries. The compact format packs 3 entries with a 16-bit key in
+// 32 bytes. The wide format packs 5 entries with a 32-bit key in 64 bytes, so it holds
+// about 17% fewer entries for the same size, but with a 65536 times lower chance of a
+// false hit. With tables of hundreds of GB, where entries are rarely overwritten before
+// being probed again, those false hits are otherwise no longer negligible.
+enum class TTFormat {
+    Compact,
+    Wide
+};
+
+
+// Counters of a single thread, updated by `probe` and by the writer it returns when
+// given, so that threads never write to the same counters. Hits are bucketed by the
+// depth of the entry found. With the wide format, `aliases` counts the entries whose
+// low 16 key bits match a probed position they don't belong to, which the compact
+// format would have returned as a hit.
+struct TTStats {
+    static constexpr int DepthBuckets = 8;
+
+    // Quiescence entries, then depths 1-4, 5-8, ..., 21-24 and 25 onwards
+    static constexpr int depth_bucket(Depth d) {
+        return d <= 0 ? 0 : std::min((d - 1) / 4 + 1, DepthBuckets - 1);
+    }
+
+    uint64_t probes               = 0;
+    uint64_t hits[DepthBuckets]   = {};
+    uint64_t misses               = 0;
+    uint64_t aliases              = 0;
+    uint64_t writes               = 0;
+    uint64_t sameKeyOverwrites    = 0;  // Writes replacing the data of the same position
+    uint64_t deeperReplacements   = 0;  // Writes evicting another position searched deeper
+
+    uint64_t total_hits() const;
+    TTStats& operator+=(const TTStats& other);
+};
+
+
 // This is used to make racy writes to the global TT.
 struct TTWriter {
    public:
@@ -73,18 +113,57 @@ struct TTWriter {
 
    private:
     friend class TranspositionTable;
-    TTEntry* entry;
-    TTWriter(TTEntry* tte);
+    void*    entry;
+    TTFormat format;
+    TTStats* stats;
+    TTWriter(void* tte, TTFormat f, TTStats* st);
+};
+
+
+// How the table is spread over the NUMA nodes. Memory is placed on the node of the
+// thread that first touches it, which is the thread that clears it. By default each
+// thread clears a contiguous slice. Otherwise the table is split in 2 MiB chunks, that
+// are either dealt round-robin to the nodes, or grouped into one contiguous part per
+// node. Since clusters are indexed by the upper key bits, the latter partitions the
+// table by key.
+enum class TTNumaPlacement {
+    Auto,
+    Interleave,
+    Partition
+};
+
+// Where the memory of the table comes from and how it is laid out. By default it is
+// private to the process.
+struct TTStorage {
+    TTFormat          format = TTFormat::Compact;
+    std::string       file;        // Back the table by this file, keeping its contents across runs
+    std::string       sharedName;  // Share the table with the other processes using this name
+    TTNumaPlacement   numaPlacement = TTNumaPlacement::Auto;
+    const NumaConfig* numaConfig    = nullptr;
 };
 
 
 class TranspositionTable {
 
    public:
-    ~TranspositionTable() { aligned_large_pages_free(table); }
-
-    void resize(size_t mbSize, ThreadPool& threads);  // Set TT size
-    void clear(ThreadPool& threads);                  // Re-initialize memory, multithreaded
+    TranspositionTable();
+    ~TranspositionTable();
+
+    void resize(size_t mbSize, ThreadPool& threads, const TTStorage& storage = {});  // Set TT size
+    void clear(ThreadPool& threads);  // Re-initialize memory, multithreaded
+    bool save(const std::string& path) const;  // Dump the table contents to a file
+    bool load(const std::string& path);        // Restore contents previously saved
+    bool is_file_backed() const { return mappedFile != nullptr; }
+
+    // Whether the entries of a previous run, mapped or loaded, are still to be
+    // kept by a new game. Only the first new game keeps them, and any clear
+    // wipes them.
+    bool keep_for_new_game() { return std::exchange(keepContents, false); }
+    bool is_shared() const { return sharedRegion != nullptr; }
+
+    // Whether the NUMA node holding each cluster is known, and which node that is
+    bool   is_numa_placed() const { return numaPlacement != TTNumaPlacement::Auto; }
+    size_t numa_node_of(const Key key) const;
     int  hashfull(int maxAge = 0)
       const;  // Approximate what fraction of entries (permille) have been written to during this root search
 
@@ -92,15 +171,49 @@ class TranspositionTable {
     new_search();  // This must be called at the beginning of each root search to track entry aging
     uint8_t generation() const;  // The current age, used when writing new data to the TT
     std::tuple<bool, TTData, TTWriter>
-    probe(const Key key) const;  // The main method, whose retvals separate local vs global objects
-    TTEntry* first_entry(const Key key)
+    probe(const Key     key,
+          TTStats*  stats = nullptr) const;  // The main method, whose retvals separate local vs global objects
+    void* first_entry(const Key key)
       const;  // This is the hash function; its only external use is memory prefetching.
+    TTFormat entry_format() const { return format; }
 
    private:
-    friend struct TTEntry;
-
+    struct SharedRegion;
+
+    template<typename ClusterType>
+    std::tuple<bool, TTData, TTWriter> probe(const Key key, TTStats* stats) const;
+    template<typename ClusterType>
+    int hashfull(int maxAge) const;
+    template<typename ClusterType>
+    void rehash(const char* oldTable, size_t oldClusterCount, ThreadPool& threads);
+
+    void free_table();
+    void   clear_numa_placed(ThreadPool& threads);
+    void   clear_chunk(size_t chunk);
+    size_t chunk_node(size_t chunk) const;
+
+    TTFormat format       = TTFormat::Compact;
+    uint64_t formatHash   = 0;
+    size_t   clusterBytes = 0;
     size_t   clusterCount;
-    Cluster* table = nullptr;
+    char*    table = nullptr;
+
+    // When backed by a file, the mapping holds a header followed by the clusters
+    void*  mappedFile = nullptr;
+    size_t mappedSize = 0;
+
+    // Set while the table holds the entries of a previous run, mapped or loaded,
+    // which the first new game keeps
+    bool keepContents = false;
+
+    // When shared between processes, the named shared memory region
+    std::unique_ptr<SharedRegion> sharedRegion;
+
+    TTNumaPlacement   numaPlacement = TTNumaPlacement::Auto;
+    const NumaConfig* numaConfig    = nullptr;
+    size_t            numaNodes        = 1;
+    size_t            clustersPerChunk = 1;
+    size_t            chunkCount       = 0;
 
     uint8_t generation8 = 0;  // Size must be not bigger than TTEntry::genBound8
 };
@@ -192,7 +192,15 @@ constexpr bool is_decisive(Value value) { return is_win(value) || is_loss(value)
 enum GamePhase : int8_t {
     OPENING,
     MIDDLEGAME,
-    ENDGAME
+    ENDGAME,
+    PHASE_NB
+};
+
+// The part of the game phase given by the material, kept in StateInfo. With the
+// material of an opening, the position is in the opening up to openingPlies.
+struct MaterialPhase {
+    GamePhase phase;
+    uint8_t   openingPlies;
 };
 
 // In the code, we make the assumption that these values
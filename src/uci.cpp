@@ -20,19 +20,24 @@
 
 #include <algorithm>
 #include <cctype>
+#include <chrono>
 #include <cmath>
 #include <cstdint>
+#include <fstream>
 #include <iterator>
 #include <optional>
 #include <sstream>
 #include <string_view>
+#include <thread>
 #include <utility>
 #include <vector>
 
 #include "benchmark.h"
 #include "engine.h"
+#include "evalcache.h"
 #include "memory.h"
 #include "movegen.h"
+#include "numa.h"
 #include "position.h"
 #include "score.h"
 #include "search.h"
@@ -132,7 +137,7 @@ void UCIEngine::loop() {
         else if (token == "position")
             position(is);
         else if (token == "ucinewgame")
-            engine.search_clear();
+            engine.search_clear(true);
         else if (token == "isready")
             sync_cout << "readyok" << sync_endl;
 
@@ -144,12 +149,58 @@ void UCIEngine::loop() {
             bench(is);
         else if (token == BenchmarkCommand)
             benchmark(is);
+        else if (token == "bench_ab")
+            bench_ab(is);
+        else if (token == "stop_bench")
+            stop_bench(is);
+        else if (token == "analyze")
+            analyze(is);
+        else if (token == "evalbatch")
+            evalbatch(is);
         else if (token == "d")
             sync_cout << engine.visualize() << sync_endl;
         else if (token == "eval")
             engine.trace_eval();
         else if (token == "compiler")
             sync_cout << compiler_info() << sync_endl;
+        else if (token == "hashstats")
+            sync_cout << engine.tt_stats_as_string() << sync_endl;
+        else if (token == "domove_bench")
+        {
+            Depth depth = 5;
+            is >> depth;
+            const bool isChess960 = engine.get_options()["UCI_Chess960"];
+            sync_cout << Benchmark::make_move_benchmark(engine.fen(), isChess960, std::max(depth, 1))
+                      << sync_endl;
+        }
+        else if (token == "nodes_bench")
+        {
+            size_t threads = 256;
+            is >> threads;
+            sync_cout << Benchmark::node_count_benchmark(std::max<size_t>(threads, 1))
+                      << sync_endl;
+        }
+        else if (token == "accumulator_bench")
+        {
+            Depth depth = 4;
+            is >> depth;
+            const std::string result = engine.accumulator_benchmark(std::max(depth, 1));
+            sync_cout << result << sync_endl;
+        }
+        else if (token == "nnuebench")
+        {
+            int rounds = 10;
+            is >> rounds;
+            const std::string result = engine.nnue_benchmark(std::max(rounds, 1));
+            sync_cout << result << sync_endl;
+        }
+        else if (token == "evalcache_bench")
+        {
+            size_t threads = get_hardware_concurrency(), mbSize = 1;
+            is >> threads >> mbSize;
+            sync_cout << eval_cache_scaling_benchmark(std::max<size_t>(threads, 1), mbSize)
+                      << sync_endl;
+        }
         else if (token == "export_net")
         {
             std::pair<std::optional<std::string>, std::string> files[2];
@@ -162,6 +213,42 @@ void UCIEngine::loop() {
 
             engine.save_network(files);
         }
+        else if (token == "export_runtime_net")
+        {
+            // Without file names, the runtime copies of the default nets are saved
+            // where the engine looks for them at startup
+            std::string bigFile, smallFile;
+            is >> std::skipws >> bigFile >> smallFile;
+
+            const bool saved =
+              bigFile.empty()
+                ? engine.save_runtime_networks(std::nullopt, std::nullopt)
+                : engine.save_runtime_networks(bigFile, smallFile);
+            sync_cout << (saved ? "Runtime networks saved successfully"
+                                : "Failed to export the runtime networks")
+                      << sync_endl;
+        }
+        else if (token == "export_hash" || token == "import_hash")
+        {
+            std::string file;
+            is >> std::skipws >> file;
+
+            // Both wait for a running search, which must still be able to print
+            if (token == "export_hash")
+            {
+                const bool saved = !file.empty() && engine.save_tt(file);
+                sync_cout << (saved ? "Hash saved successfully to " + file
+                                    : "Failed to export the hash")
+                          << sync_endl;
+            }
+            else
+            {
+                const bool loaded = !file.empty() && engine.load_tt(file);
+                sync_cout << (loaded ? "Hash loaded successfully from " + file
+                                     : "Failed to import the hash, the file must match the Hash size")
+                          << sync_endl;
+            }
+        }
         else if (token == "--help" || token == "help" || token == "--license" || token == "license")
             sync_cout
               << "\nCapablanca es un motor UCI para jugar y analizar ajedrez."
@@ -207,6 +294,11 @@ Search::LimitsType UCIEngine::parse_limits(std::istream& is) {
             is >> limits.mate;
         else if (token == "perft")
             is >> limits.perft;
+        // Perft only, after its depth: the threads and the size of the perft table
+        else if (limits.perft && token == "threads")
+            is >> limits.perftThreads;
+        else if (limits.perft && token == "hash")
+            is >> limits.perftHash;
         else if (token == "infinite")
             limits.infinite = 1;
         else if (token == "ponder")
@@ -231,6 +323,8 @@ void UCIEngine::bench(std::istream& args) {
     uint64_t    nodesSearched = 0;
     const auto& options       = engine.get_options();
 
+    EvalCache::Stats evalCacheStats;
+
     engine.set_on_update_full([&](const auto& i) {
         nodesSearched = i.nodes;
         on_update_full(i, options["UCI_ShowWDL"]);
@@ -262,6 +356,7 @@ void UCIEngine::bench(std::istream& args) {
                 {
                     engine.go(limits);
                     engine.wait_for_search_finished();
+                    evalCacheStats += engine.get_eval_cache_stats();
                 }
 
                 nodes += nodesSearched;
@@ -285,10 +380,12 @@ void UCIEngine::bench(std::istream& args) {
 
     dbg_print();
 
-    std::cerr << "\n==========================="    //
-              << "\nTotal time (ms) : " << elapsed  //
-              << "\nNodes searched  : " << nodes    //
-              << "\nNodes/second    : " << 1000 * nodes / elapsed << std::endl;
+    std::cerr << "\n==========================="                       //
+              << "\nTotal time (ms) : " << elapsed                     //
+              << "\nNodes searched  : " << nodes                       //
+              << "\nNodes/second    : " << 1000 * nodes / elapsed      //
+              << "\nEval cache hits : " << int(evalCacheStats.hitRate() * 10) / 10.0 << "%"
+              << std::endl;
 
     // reset callback, to not capture a dangling reference to nodesSearched
     engine.set_on_update_full([&](const auto& i) { on_update_full(i, options["UCI_ShowWDL"]); });
@@ -380,6 +477,11 @@ void UCIEngine::benchmark(std::istream& args) {
         }
     };
 
+    uint64_t ttLocalProbes = 0, ttRemoteProbes = 0;
+    TTStats  ttStats;
+
+    EvalCache::Stats evalCacheStats;
+
     engine.search_clear();  // search_clear may take a while
 
     for (const auto& cmd : setup.commands)
@@ -404,6 +506,13 @@ void UCIEngine::benchmark(std::istream& args) {
 
             updateHashfullReadings();
 
+            const auto [local, remote] = engine.get_tt_numa_probes();
+            ttLocalProbes += local;
+            ttRemoteProbes += remote;
+
+            ttStats += engine.get_tt_stats();
+            evalCacheStats += engine.get_eval_cache_stats();
+
             nodes += nodesSearched;
             nodesSearched = 0;
         }
@@ -429,6 +538,39 @@ void UCIEngine::benchmark(std::istream& args) {
     if (threadBinding.empty())
         threadBinding = "none";
 
+    const auto& ttPlacement = engine.get_options()["HashNumaPlacement"];
+    std::string ttNumaProbes =
+      ttPlacement == "auto" || ttLocalProbes + ttRemoteProbes == 0
+        ? "unknown"
+        : std::to_string(ttLocalProbes * 100 / (ttLocalProbes + ttRemoteProbes)) + ", "
+            + std::to_string(ttRemoteProbes * 100 / (ttLocalProbes + ttRemoteProbes));
+
+    // Only collected with HashStats, aliases are only told apart from hits by the wide format
+    const auto& ttFormat = engine.get_options()["HashFormat"];
+    const bool  hasStats = engine.get_options()["HashStats"] && ttStats.probes;
+    const auto  percent  = [](uint64_t n, uint64_t total) {
+        return std::to_string(total ? n * 100 / total : 0);
+    };
+
+    std::string ttHits = "unknown", ttHitsByDepth = "unknown", ttWrites = "unknown";
+    std::string ttAliasRate = "unknown";
+
+    if (hasStats)
+    {
+        const uint64_t hits = ttStats.total_hits();
+
+        ttHits        = std::to_string(ttStats.probes) + ", " + percent(hits, ttStats.probes);
+        ttHitsByDepth = percent(ttStats.hits[0], hits);
+        for (int i = 1; i < TTStats::DepthBuckets; ++i)
+            ttHitsByDepth += ", " + percent(ttStats.hits[i], hits);
+
+        ttWrites = percent(ttStats.sameKeyOverwrites, ttStats.writes) + ", "
+                 + percent(ttStats.deeperReplacements, ttStats.writes);
+
+        if (ttFormat == "wide")
+            ttAliasRate = std::to_string(ttStats.aliases * 1000000 / ttStats.probes);
+    }
+
     // clang-format off
 
     std::cerr << "==========================="
@@ -444,6 +586,13 @@ void UCIEngine::benchmark(std::istream& args) {
               << "\nThread count               : " << setup.threads
               << "\nThread binding             : " << threadBinding
               << "\nTT size [MiB]              : " << setup.ttSize
+              << "\nTT NUMA local/remote [%]   : " << ttNumaProbes
+              << "\nTT format                  : " << std::string(ttFormat)
+              << "\nTT probes, hits [%]        : " << ttHits
+              << "\nTT hits by depth [%]       : " << ttHitsByDepth
+              << "\nTT same key, deeper [%]    : " << ttWrites
+              << "\nTT key16 aliases [per 1M]  : " << ttAliasRate
+              << "\nEval cache hits [%]        : " << int(evalCacheStats.hitRate())
               << "\nHash max, avg [per mille]  : "
               << "\n    single search          : " << maxHashfull[0] << ", "
               << totalHashfull[0] / numHashfullReadings
@@ -458,13 +607,417 @@ void UCIEngine::benchmark(std::istream& args) {
     init_search_update_listeners();
 }
 
+void UCIEngine::bench_ab(std::istream& args) {
+    std::string token;
+    uint64_t    cnt = 1, nodesSearched = 0;
+
+    const std::string backend = engine.get_options()["SearchBackend"];
+
+    std::vector<Benchmark::SearchABResult> results;
+    std::vector<TimePoint>                 depthTime;  // Of the current search
+
+    engine.set_on_update_full([&](const Engine::InfoFull& i) {
+        nodesSearched = i.nodes;
+        if (i.depth >= int(depthTime.size()))
+            depthTime.resize(i.depth + 1, -1);
+        depthTime[i.depth] = i.timeMs;
+    });
+
+    engine.set_on_iter([](const auto&) {});
+    engine.set_on_update_no_moves([](const auto&) {});
+    engine.set_on_bestmove([](const auto&, const auto&) {});
+
+    std::vector<std::string> list = Benchmark::setup_search_ab(engine.fen(), args);
+
+    const auto num = count_if(list.begin(), list.end(),
+                              [](const std::string& s) { return s.find("go ") == 0; });
+
+    for (const auto& cmd : list)
+    {
+        std::istringstream is(cmd);
+        is >> std::skipws >> token;
+
+        if (token == "go")
+        {
+            // One new line is produced by the search, so omit it here
+            std::cerr << "\rPosition " << cnt++ << '/' << num;
+
+            Search::LimitsType limits = parse_limits(is);
+
+            TimePoint elapsed = now();
+
+            engine.go(limits);
+            engine.wait_for_search_finished();
+
+            results.back().add_search(nodesSearched, now() - elapsed, depthTime);
+
+            nodesSearched = 0;
+            depthTime.clear();
+        }
+        else if (token == "setoption")
+        {
+            setoption(is);
+
+            if (cmd.find("SearchBackend") != std::string::npos)
+                results.emplace_back().backend = std::string(engine.get_options()["SearchBackend"]);
+        }
+        else if (token == "position")
+            position(is);
+        else if (token == "ucinewgame")
+            engine.search_clear();  // search_clear may take a while
+    }
+
+    std::cerr << '\n' << Benchmark::format_search_ab(results) << std::endl;
+
+    std::istringstream restore("name SearchBackend value " + backend);
+    setoption(restore);
+
+    init_search_update_listeners();
+}
+
+// Measures how late the searches end, in microseconds, on the default bench
+// positions:
+//
+// stop_bench [movetime] [threads]
+//
+// Each position is searched with 'go movetime', once stopped by the time checks
+// of the main thread and once by the TimerThread, giving the overshoot of the
+// deadline at the bestmove. Then it is searched with 'go infinite' and stopped
+// after movetime, giving the latency of 'stop' to the bestmove.
+void UCIEngine::stop_bench(std::istream& args) {
+    std::string movetime = "100", threads = "1", token;
+    args >> movetime >> threads;
+
+    const bool timerThread = engine.get_options()["TimerThread"];
+
+    using Clock = std::chrono::steady_clock;
+    Clock::time_point bestmoveTime;
+
+    engine.set_on_update_full([](const auto&) {});
+    engine.set_on_iter([](const auto&) {});
+    engine.set_on_update_no_moves([](const auto&) {});
+    engine.set_on_bestmove([&](const auto&, const auto&) { bestmoveTime = Clock::now(); });
+
+    auto micros = [](Clock::duration d) {
+        return int64_t(std::chrono::duration_cast<std::chrono::microseconds>(d).count());
+    };
+
+    std::istringstream             benchArgs("16 " + threads + " " + movetime + " default movetime");
+    const std::vector<std::string> list = Benchmark::setup_bench(engine.fen(), benchArgs);
+
+    const auto num = count_if(list.begin(), list.end(),
+                              [](const std::string& s) { return s.find("go ") == 0; });
+
+    std::vector<int64_t> polled, timed, stopped;
+    uint64_t             cnt = 1;
+
+    for (const auto& cmd : list)
+    {
+        std::istringstream is(cmd);
+        is >> std::skipws >> token;
+
+        if (token == "go")
+        {
+            std::cerr << "\rPosition " << cnt++ << '/' << num << std::flush;
+
+            Search::LimitsType limits = parse_limits(is);
+
+            for (bool timer : {false, true})
+            {
+                std::istringstream option(std::string("name TimerThread value ")
+                                          + (timer ? "true" : "false"));
+                setoption(option);
+
+                // The deadline is counted from the millisecond of the start time
+                limits.startTime            = now();
+                const Clock::time_point end = Clock::time_point(
+                  std::chrono::milliseconds(limits.startTime + limits.movetime));
+
+                engine.go(limits);
+                engine.wait_for_search_finished();
+
+                (timer ? timed : polled).push_back(micros(bestmoveTime - end));
+            }
+
+            Search::LimitsType infinite;
+            infinite.infinite  = true;
+            infinite.startTime = now();
+
+            engine.go(infinite);
+            std::this_thread::sleep_for(std::chrono::milliseconds(limits.movetime));
+
+            const Clock::time_point stopTime = Clock::now();
+            engine.stop();
+            engine.wait_for_search_finished();
+
+            stopped.push_back(micros(bestmoveTime - stopTime));
+        }
+        else if (token == "setoption")
+            setoption(is);
+        else if (token == "position")
+            position(is);
+        else if (token == "ucinewgame")
+            engine.search_clear();  // search_clear may take a while
+    }
+
+    std::cerr << "\n==========================="
+              << "\n" << Benchmark::format_latencies("Overshoot, polling [us]", polled)
+              << "\n" << Benchmark::format_latencies("Overshoot, TimerThread [us]", timed)
+              << "\n" << Benchmark::format_latencies("Stop to bestmove [us]", stopped) << std::endl;
+
+    std::istringstream restore(std::string("name TimerThread value ")
+                               + (timerThread ? "true" : "false"));
+    setoption(restore);
+
+    init_search_update_listeners();
+}
+
+// Analyzes the positions of an EPD file, each one searched alone on one thread of
+// the pool, and prints the result of each search as soon as it is done:
+//
+// analyze <file> [depth|nodes] [limit]
+//
+// The lines hold the 4 fields of an EPD position, optionally followed by the move
+// counters of a FEN and by EPD operations, of which only 'id' is used. An invalid
+// position is reported on stderr and skipped, the results are numbered by the
+// positions of the file.
+void UCIEngine::analyze(std::istream& args) {
+    std::string file, limitType, token;
+    uint64_t    limit = 13;
+
+    args >> file;
+    if (args >> limitType)
+        args >> limit;
+
+    std::ifstream epd(file);
+    if (!epd.is_open())
+    {
+        sync_cout << "Unable to open file " << file << sync_endl;
+        return;
+    }
+
+    std::vector<std::string> fens, ids;
+    std::vector<size_t>      numbers;  // In the file, counting the invalid positions
+    size_t                   lineNumber = 0, positions = 0;
+
+    auto isNumber = [](const std::string& s) {
+        return std::all_of(s.begin(), s.end(),
+                           [](char c) { return std::isdigit(static_cast<unsigned char>(c)); });
+    };
+
+    for (std::string line; std::getline(epd, line);)
+    {
+        std::istringstream       ls(line);
+        std::vector<std::string> fields{std::istream_iterator<std::string>(ls), {}};
+
+        ++lineNumber;
+        if (fields.empty() || fields[0][0] == '#')
+            continue;
+
+        std::string fen = line;
+        if (fields.size() >= 4)
+        {
+            fen = fields[0] + " " + fields[1] + " " + fields[2] + " " + fields[3];
+            for (size_t i = 4; i < std::min<size_t>(fields.size(), 6) && isNumber(fields[i]); ++i)
+                fen += " " + fields[i];
+        }
+
+        ++positions;
+
+        // Reported and skipped, the next positions keep their numbers
+        if (const auto error = Position::fen_error(fen))
+        {
+            std::cerr << "Invalid FEN on line " << lineNumber << ", " << *error << ": " << line
+                      << std::endl;
+            continue;
+        }
+
+        std::string  id;
+        const size_t idPos = line.find("id \"");
+        if (idPos != std::string::npos)
+            id = line.substr(idPos + 4, line.find('"', idPos + 4) - idPos - 4);
+
+        fens.push_back(fen);
+        ids.push_back(id);
+        numbers.push_back(positions);
+    }
+
+    Search::LimitsType limits;
+    limits.startTime = now();
+
+    if (limitType == "nodes")
+        limits.nodes = limit;
+    else
+        limits.depth = int(limit);
+
+    const bool            isChess960 = engine.get_options()["UCI_Chess960"];
+    std::atomic<uint64_t> nodes{0};
+
+    engine.analyze(fens, limits, [&](size_t i, const Search::AnalysisResult& result) {
+        std::string pv;
+        for (Move m : result.pv)
+            pv += " " + move(m, isChess960);
+
+        nodes += result.nodes;
+
+        sync_cout << "result " << numbers[i] << (ids[i].empty() ? "" : " id \"" + ids[i] + "\"")
+                  << " depth " << result.depth << " score " << format_score(result.score)
+                  << " nodes " << result.nodes << " bestmove "
+                  << move(result.pv.empty() ? Move::none() : result.pv[0], isChess960) << " pv"
+                  << pv << sync_endl;
+    });
+
+    const TimePoint elapsed = now() - limits.startTime + 1;  // Ensure positivity
+
+    std::cerr << "\n==========================="
+              << "\nPositions analyzed : " << fens.size()          //
+              << "\nTotal time (ms)    : " << elapsed              //
+              << "\nNodes searched     : " << nodes                //
+              << "\nNodes/second       : " << 1000 * nodes / elapsed //
+              << "\nPositions/second   : " << 1000.0 * fens.size() / elapsed << std::endl;
+}
+
+// Evaluates the positions of a file, or of the standard input up to a line "end"
+// when the file is "-", one FEN per line, on all the threads:
+//
+// evalbatch <file|-> [net auto|small|big] [binary <output file>]
+//
+// The static evaluations, from the point of view of the side to move and in
+// internal units, are printed one per line in the order of the positions, "none"
+// for a side to move in check and "invalid" for a line that is not a valid FEN,
+// which is reported on stderr. With 'binary' they are written instead to the
+// output file as little-endian 16-bit integers, VALUE_NONE for both.
+void UCIEngine::evalbatch(std::istream& args) {
+    constexpr size_t ChunkSize = 1 << 16;
+
+    std::string        file, token, outFile;
+    Eval::NetSelection net = Eval::NetSelection::Auto;
+
+    args >> file;
+    while (args >> token)
+        if (token == "net" && args >> token)
+            net = token == "small" ? Eval::NetSelection::Small
+                : token == "big"   ? Eval::NetSelection::Big
+                                   : Eval::NetSelection::Auto;
+        else if (token == "binary")
+            args >> outFile;
+
+    std::ifstream fenFile;
+    if (file != "-")
+    {
+        fenFile.open(file);
+        if (!fenFile.is_open())
+        {
+            sync_cout << "Unable to open file " << file << sync_endl;
+            return;
+        }
+    }
+
+    std::ofstream binary;
+    if (!outFile.empty())
+    {
+        binary.open(outFile, std::ios::binary);
+        if (!binary.is_open())
+        {
+            sync_cout << "Unable to open file " << outFile << sync_endl;
+            return;
+        }
+    }
+
+    std::istream&            in = file == "-" ? std::cin : fenFile;
+    std::vector<std::string> fens;
+    std::vector<size_t>      invalid;  // Indices in the chunk of the invalid lines
+    std::vector<int16_t>     packed;
+    std::string              output, line;
+    uint64_t                 count = 0, lineNumber = 0;
+    bool                     endSeen = false;
+    const TimePoint          start   = now();
+
+    fens.reserve(ChunkSize);
+
+    // The positions are read and evaluated by chunks, so that the threads get
+    // enough work at once without holding the whole input in memory.
+    while (!endSeen)
+    {
+        fens.clear();
+        invalid.clear();
+        while (fens.size() + invalid.size() < ChunkSize && std::getline(in, line))
+        {
+            ++lineNumber;
+            if (file == "-" && line == "end")
+            {
+                endSeen = true;
+                break;
+            }
+            if (line.empty())
+                continue;
+
+            // Reported and skipped, keeping its place in the output
+            if (const auto error = Position::fen_error(line))
+            {
+                std::cerr << "Invalid FEN on line " << lineNumber << ", " << *error << ": "
+                          << line << std::endl;
+                invalid.push_back(fens.size() + invalid.size());
+            }
+            else
+                fens.push_back(line);
+        }
+
+        endSeen = endSeen || !in;
+        if (fens.empty() && invalid.empty())
+            continue;
+
+        const std::vector<Value> values =
+          fens.empty() ? std::vector<Value>() : engine.evaluate(fens, net);
+        count += values.size();
+
+        packed.clear();
+        output.clear();
+        for (size_t i = 0, next = 0, bad = 0; i < values.size() + invalid.size(); ++i)
+        {
+            const bool  isInvalid = bad < invalid.size() && invalid[bad] == i;
+            const Value v         = isInvalid ? VALUE_NONE : values[next++];
+            bad += isInvalid;
+
+            if (binary.is_open())
+            {
+                const uint16_t u = uint16_t(v);
+                packed.push_back(int16_t(IsLittleEndian ? u : uint16_t(u << 8 | u >> 8)));
+            }
+            else
+                output += (isInvalid      ? "invalid"
+                           : v == VALUE_NONE ? "none"
+                                             : std::to_string(v))
+                        + '\n';
+        }
+
+        if (binary.is_open())
+        {
+            binary.write(reinterpret_cast<const char*>(packed.data()),
+                         std::streamsize(packed.size() * sizeof(int16_t)));
+            continue;
+        }
+
+        output.pop_back();
+        sync_cout << output << sync_endl;
+    }
+
+    const TimePoint elapsed = now() - start + 1;  // Ensure positivity
+
+    std::cerr << "\n==========================="
+              << "\nPositions evaluated : " << count    //
+              << "\nTotal time (ms)     : " << elapsed  //
+              << "\nEvaluations/second  : " << 1000 * count / elapsed << std::endl;
+}
+
 void UCIEngine::setoption(std::istringstream& is) {
     engine.wait_for_search_finished();
     engine.get_options().setoption(is);
 }
 
 std::uint64_t UCIEngine::perft(const Search::LimitsType& limits) {
-    auto nodes = engine.perft(engine.fen(), limits.perft, engine.get_options()["UCI_Chess960"]);
+    auto nodes = engine.perft(engine.fen(), limits.perft, engine.get_options()["UCI_Chess960"],
+                              limits.perftThreads, limits.perftHash);
     sync_cout << "\nNodes searched: " << nodes << "\n" << sync_endl;
     return nodes;
 }
@@ -63,6 +63,10 @@ class UCIEngine {
     void          go(std::istringstream& is);
     void          bench(std::istream& args);
     void          benchmark(std::istream& args);
+    void          bench_ab(std::istream& args);
+    void          stop_bench(std::istream& args);
+    void          analyze(std::istream& args);
+    void          evalbatch(std::istream& args);
     void          position(std::istringstream& is);
     void          setoption(std::istringstream& is);
     std::uint64_t perft(const Search::LimitsType&);
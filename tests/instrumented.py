@@ -1,9 +1,11 @@
 import argparse
+import ctypes
 import re
 import sys
 import subprocess
 import pathlib
 import os
+import time
 
 from testing import (
     EPD,
@@ -38,6 +40,10 @@ def get_path():
     return os.path.abspath(os.path.join(CWD, args.stockfish_path))
 
 
+def get_library_path():
+    return os.path.join(os.path.dirname(get_path()), "libcapablanca.so")
+
+
 def postfix_check(output):
     if args.sanitizer_undefined:
         for idx, line in enumerate(output):
@@ -152,6 +158,43 @@ class TestCLI(metaclass=OrderedClassMembers):
         self.stockfish = Stockfish("d".split(" "), True)
         assert self.stockfish.process.returncode == 0
 
+    def test_evalbatch_invalid_lines(self):
+        fens = [
+            "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1",
+            "this is not a fen",
+            "8/8/8/8/8/8/8/8 w - - 0 1",
+            "4k3/8/8/8/8/8/8/4K3 x - - 0 1",
+            "4k3/8/8/8/8/8/4Q3/4K3 w - - 0 1",
+        ]
+        with open("evalbatch_tmp.txt", "w") as f:
+            f.write("\n".join(fens) + "\n")
+
+        self.stockfish = Stockfish("evalbatch evalbatch_tmp.txt".split(" "), True)
+        assert self.stockfish.process.returncode == 0
+
+        # The invalid lines keep their place in the output
+        values = self.stockfish.process.stdout.splitlines()[-len(fens) :]
+        assert values[0].lstrip("-").isdigit()
+        assert values[1:] == ["invalid"] * 4
+        assert self.stockfish.process.stderr.count("Invalid FEN") == 4
+
+    def test_analyze_invalid_lines(self):
+        with open("analyze_tmp.epd", "w") as f:
+            f.write("this is not a fen\n")
+            f.write('8/8/8/8/8/8/8/8 w - - id "no kings";\n')
+            f.write('4k3/8/8/8/8/8/8/4K3 w - - id "kings";\n')
+
+        self.stockfish = Stockfish("analyze analyze_tmp.epd depth 2".split(" "), True)
+        assert self.stockfish.process.returncode == 0
+
+        results = [
+            line
+            for line in self.stockfish.process.stdout.splitlines()
+            if line.startswith("result")
+        ]
+        assert len(results) == 1 and results[0].startswith('result 3 id "kings"')
+        assert self.stockfish.process.stderr.count("Invalid FEN") == 2
+
     def test_compiler(self):
         self.stockfish = Stockfish("compiler".split(" "), True)
         assert self.stockfish.process.returncode == 0
@@ -235,6 +278,54 @@ class TestInteractive(metaclass=OrderedClassMembers):
         self.stockfish.send_command("go nodes 1000")
         self.stockfish.starts_with("bestmove")
 
+    def read_key(self):
+        key = None
+
+        def callback(output):
+            nonlocal key
+            if output.startswith("Key: "):
+                key = output
+                return True
+            return False
+
+        self.stockfish.send_command("d")
+        self.stockfish.check_output(callback)
+        return key
+
+    def test_extended_position_same_key(self):
+        self.stockfish.send_command("position startpos moves e2e4 e7e6")
+        self.stockfish.send_command("go nodes 1000")
+        self.stockfish.starts_with("bestmove")
+
+        # Only the new moves are played on the states of the last search
+        self.stockfish.send_command("position startpos moves e2e4 e7e6 d2d4 d7d5")
+        extended = self.read_key()
+
+        self.stockfish.send_command(
+            "position fen rnbqkbnr/ppp2ppp/4p3/3p4/3PP3/8/PPP2PPP/RNBQKBNR w KQkq - 0 3"
+        )
+        assert self.read_key() == extended
+
+    def test_position_during_infinite_search(self):
+        # The helper threads search until stop, which must not wait for them
+        self.stockfish.send_command("setoption name Threads value 2")
+        self.stockfish.send_command("position startpos moves e2e4")
+        self.stockfish.send_command("go infinite")
+        self.stockfish.send_command("position startpos moves e2e4 e7e5")
+        self.stockfish.send_command("stop")
+        self.stockfish.starts_with("bestmove")
+
+        self.stockfish.send_command("isready")
+        self.stockfish.equals("readyok")
+
+        extended = self.read_key()
+        self.stockfish.send_command(
+            "position fen rnbqkbnr/pppp1ppp/8/4p3/4P3/8/PPPP1PPP/RNBQKBNR w KQkq - 0 2"
+        )
+        assert self.read_key() == extended
+
+        self.stockfish.send_command(f"setoption name Threads value {get_threads()}")
+
     def test_fen_position_1(self):
         self.stockfish.send_command("ucinewgame")
         self.stockfish.send_command("position fen 5rk1/1K4p1/8/8/3B4/8/8/8 b - - 0 1")
@@ -476,6 +567,190 @@ class TestSyzygy(metaclass=OrderedClassMembers):
         self.stockfish.expect("bestmove *")
 
 
+class TestCAPI(metaclass=OrderedClassMembers):
+    MessageCallback = ctypes.CFUNCTYPE(None, ctypes.c_void_p, ctypes.c_char_p)
+    BestmoveCallback = ctypes.CFUNCTYPE(
+        None, ctypes.c_void_p, ctypes.c_char_p, ctypes.c_char_p
+    )
+
+    class Info(ctypes.Structure):
+        _fields_ = [
+            ("depth", ctypes.c_int),
+            ("selDepth", ctypes.c_int),
+            ("multiPV", ctypes.c_size_t),
+            ("scoreKind", ctypes.c_int),
+            ("score", ctypes.c_int),
+            ("bound", ctypes.c_int),
+            ("wdl", ctypes.c_int * 3),
+            ("timeMs", ctypes.c_uint64),
+            ("nodes", ctypes.c_uint64),
+            ("nps", ctypes.c_uint64),
+            ("tbHits", ctypes.c_uint64),
+            ("hashfull", ctypes.c_int),
+            ("pv", ctypes.c_char_p),
+        ]
+
+    InfoCallback = ctypes.CFUNCTYPE(None, ctypes.c_void_p, ctypes.POINTER(Info))
+
+    class Limits(ctypes.Structure):
+        _fields_ = [
+            ("wtime", ctypes.c_int64),
+            ("btime", ctypes.c_int64),
+            ("winc", ctypes.c_int64),
+            ("binc", ctypes.c_int64),
+            ("movetime", ctypes.c_int64),
+            ("movestogo", ctypes.c_int),
+            ("depth", ctypes.c_int),
+            ("mate", ctypes.c_int),
+            ("nodes", ctypes.c_uint64),
+            ("infinite", ctypes.c_int),
+            ("ponder", ctypes.c_int),
+            ("searchmoves", ctypes.POINTER(ctypes.c_char_p)),
+            ("searchmovesCount", ctypes.c_size_t),
+        ]
+
+    def beforeAll(self):
+        self.lib = ctypes.CDLL(get_library_path())
+        self.lib.capa_host_new.restype = ctypes.c_void_p
+        self.lib.capa_host_new.argtypes = [ctypes.c_char_p, ctypes.c_size_t]
+        self.lib.capa_host_free.argtypes = [ctypes.c_void_p]
+        self.lib.capa_engine_new_on_host.restype = ctypes.c_void_p
+        self.lib.capa_engine_new_on_host.argtypes = [ctypes.c_void_p]
+        self.lib.capa_engine_free.argtypes = [ctypes.c_void_p]
+        self.lib.capa_set_option.argtypes = [
+            ctypes.c_void_p,
+            ctypes.c_char_p,
+            ctypes.c_char_p,
+        ]
+        self.lib.capa_set_message_callback.argtypes = [
+            ctypes.c_void_p,
+            self.MessageCallback,
+            ctypes.c_void_p,
+        ]
+        for name in ["capa_stop", "capa_ponderhit", "capa_wait", "capa_new_game"]:
+            getattr(self.lib, name).argtypes = [ctypes.c_void_p]
+        self.lib.capa_go.argtypes = [ctypes.c_void_p, ctypes.POINTER(self.Limits)]
+        self.lib.capa_set_bestmove_callback.argtypes = [
+            ctypes.c_void_p,
+            self.BestmoveCallback,
+            ctypes.c_void_p,
+        ]
+        self.lib.capa_set_info_callback.argtypes = [
+            ctypes.c_void_p,
+            self.InfoCallback,
+            ctypes.c_void_p,
+        ]
+        self.lib.capa_engine_new.restype = ctypes.c_void_p
+        self.lib.capa_engine_new.argtypes = [ctypes.c_char_p]
+        self.lib.capa_set_position.argtypes = [
+            ctypes.c_void_p,
+            ctypes.c_char_p,
+            ctypes.POINTER(ctypes.c_char_p),
+            ctypes.c_size_t,
+        ]
+        self.lib.capa_eval.argtypes = [
+            ctypes.c_void_p,
+            ctypes.POINTER(ctypes.c_char_p),
+            ctypes.c_size_t,
+            ctypes.c_int,
+            ctypes.POINTER(ctypes.c_int32),
+        ]
+
+    def afterAll(self):
+        pass
+
+    def test_threads_above_host_budget(self):
+        host = self.lib.capa_host_new(None, 2)
+        engine = self.lib.capa_engine_new_on_host(host)
+
+        messages = []
+        callback = self.MessageCallback(lambda _, msg: messages.append(msg.decode()))
+        self.lib.capa_set_message_callback(engine, callback, None)
+
+        # The threads of the pool live as long as the engine
+        before = len(os.listdir("/proc/self/task"))
+        assert self.lib.capa_set_option(engine, b"Threads", b"4") == 0
+        after = len(os.listdir("/proc/self/task"))
+
+        assert after - before == 1
+        assert any("Threads limited" in m for m in messages)
+
+        self.lib.capa_engine_free(engine)
+        self.lib.capa_host_free(host)
+
+    def test_depth_5_with_callbacks(self):
+        engine = self.lib.capa_engine_new(None)
+
+        moves = (ctypes.c_char_p * 2)(b"e2e4", b"e7e5")
+        assert self.lib.capa_set_position(engine, None, moves, 2) == 0
+
+        infos, bestmoves = [], []
+        on_info = self.InfoCallback(
+            lambda _, info: infos.append((info.contents.depth, info.contents.pv.decode()))
+        )
+        on_bestmove = self.BestmoveCallback(
+            lambda _, move, ponder: bestmoves.append(move.decode())
+        )
+        self.lib.capa_set_info_callback(engine, on_info, None)
+        self.lib.capa_set_bestmove_callback(engine, on_bestmove, None)
+
+        limits = self.Limits(depth=5)
+        assert self.lib.capa_go(engine, ctypes.byref(limits)) == 0
+        self.lib.capa_wait(engine)
+
+        depths = [depth for depth, _ in infos]
+        assert depths == sorted(depths) and depths[0] < depths[-1] == 5
+        assert all(pv for _, pv in infos)
+
+        assert len(bestmoves) == 1
+        assert bestmoves[0] == infos[-1][1].split()[0]
+
+        # The white king is in check from the rook
+        fens = (ctypes.c_char_p * 1)(b"4k3/8/8/8/8/8/8/4K2r w - - 0 1")
+        values = (ctypes.c_int32 * 1)()
+        assert self.lib.capa_eval(engine, fens, 1, 0, values) == 0
+        assert values[0] == -(2**31)
+
+        self.lib.capa_engine_free(engine)
+
+    def test_stop_queued_search(self):
+        host = self.lib.capa_host_new(None, 1)
+        first = self.lib.capa_engine_new_on_host(host)
+        second = self.lib.capa_engine_new_on_host(host)
+
+        bestmoves = []
+        callback = self.BestmoveCallback(lambda _, move, ponder: bestmoves.append(move))
+        self.lib.capa_set_bestmove_callback(second, callback, None)
+
+        infinite = self.Limits(infinite=1)
+        assert self.lib.capa_go(first, ctypes.byref(infinite)) == 0
+        time.sleep(0.5)
+
+        # The second search waits for the thread of the first one, but go returns
+        start = time.monotonic()
+        assert self.lib.capa_go(second, ctypes.byref(infinite)) == 0
+        assert time.monotonic() - start < 1
+
+        self.lib.capa_stop(second)
+        self.lib.capa_wait(second)
+        assert len(bestmoves) == 1
+
+        self.lib.capa_stop(first)
+        self.lib.capa_wait(first)
+
+        self.lib.capa_engine_free(second)
+        self.lib.capa_engine_free(first)
+        self.lib.capa_host_free(host)
+
+    def test_null_engine(self):
+        assert self.lib.capa_set_option(None, b"Threads", b"1") == -1
+        assert self.lib.capa_go(None, None) == -1
+
+        self.lib.capa_set_message_callback(None, self.MessageCallback(), None)
+        for name in ["capa_stop", "capa_ponderhit", "capa_wait", "capa_new_game"]:
+            getattr(self.lib, name)(None)
+
+
 def parse_args():
     parser = argparse.ArgumentParser(description="Run Stockfish with testing options")
     parser.add_argument("--valgrind", action="store_true", help="Run valgrind testing")
@@ -509,7 +784,13 @@ if __name__ == "__main__":
     framework = MiniTestFramework()
 
     # Each test suite will be run inside a temporary directory
-    framework.run([TestCLI, TestInteractive, TestSyzygy])
+    suites = [TestCLI, TestInteractive, TestSyzygy]
+
+    # The C API is tested when the library was built next to the engine
+    if sys.platform == "linux" and os.path.exists(get_library_path()):
+        suites.append(TestCAPI)
+
+    framework.run(suites)
 
     EPD.delete_bench_epd()
     TSAN.unset_tsan_option()
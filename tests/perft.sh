@@ -17,13 +17,16 @@ EXPECT_SCRIPT=$(mktemp)
 cat << 'EOF' > $EXPECT_SCRIPT
 #!/usr/bin/expect -f
 set timeout 120
-lassign [lrange $argv 0 4] pos depth result chess960 logfile
+lassign [lrange $argv 0 5] pos depth result chess960 logfile goargs
 log_file -noappend $logfile
 spawn ./stockfish
 if {$chess960 == "true"} {
   send "setoption name UCI_Chess960 value true\n"
 }
-send "position $pos\ngo perft $depth\n"
+if {$goargs != ""} {
+  send "setoption name Threads value 4\n"
+}
+send "position $pos\ngo perft $depth $goargs\n"
 expect {
   "Nodes searched: $result" {}
   timeout {puts "TIMEOUT: Expected $result nodes"; exit 1}
@@ -40,11 +43,12 @@ run_test() {
   local depth="$2"
   local expected="$3"
   local chess960="$4"
+  local goargs="$5"
   local tmp_file=$(mktemp)
 
-  echo -n "Testing depth $depth: ${pos:0:40}... "
+  echo -n "Testing depth $depth: ${pos:0:40}... $goargs "
 
-  if $EXPECT_SCRIPT "$pos" "$depth" "$expected" "$chess960" "$tmp_file" > /dev/null 2>&1; then
+  if $EXPECT_SCRIPT "$pos" "$depth" "$expected" "$chess960" "$tmp_file" "$goargs" > /dev/null 2>&1; then
     echo "OK"
     rm -f "$tmp_file"
   else
@@ -84,6 +88,13 @@ run_test "fen rr6/2kpp3/1ppnb1p1/p4q1p/P4P1P/1PNN2P1/2PP2Q1/1K2RR2 w E - 1 19" 4
 run_test "fen rr6/2kpp3/1ppnb1p1/p4q1p/P4P1P/1PNN2P1/2PP2Q1/1K2RR2 w E - 1 19" 5 79014522 "true"
 run_test "fen rr6/2kpp3/1ppnb1p1/p4q1p/P4P1P/1PNN2P1/2PP2Q1/1K2RR2 w E - 1 19" 6 2998685421 "true"
 
+# parallel perft with a perft table
+
+run_test "startpos" 6 119060324 "false" "threads 4 hash 64"
+run_test "fen r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq -" 5 193690690 "false" "threads 4 hash 1"
+run_test "fen 8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - -" 6 11030083 "false" "threads 3"
+run_test "fen 1rqbkrbn/1ppppp1p/1n6/p1N3p1/8/2P4P/PP1PPPP1/1RQBKRBN w FBfb - 0 9" 6 191762235 "true" "threads 4 hash 16"
+
 rm -f $EXPECT_SCRIPT
 echo "perft testing completed"
 